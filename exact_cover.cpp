@@ -0,0 +1,131 @@
+/*
+	Sudoku DLX Solver
+	
+	Copyright (c) 2026 Royal_X (MIT License)
+ 
+ 	https://github.com/RoyalXXX
+  	https://royalxxx.itch.io
+   	https://sourceforge.net/u/royal-x
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// Command-line front end for exact cover problems in Knuth's DLX1 format, with DLX2 colors
+// and DLX3 multiplicities:
+//
+//   exact_cover [-a] [-n limit] [-m] [file]
+//
+// Reads `file` (standard input when omitted) and prints the number of solutions and search
+// nodes. -a also prints every solution, one option per line, and -n stops after `limit`
+// solutions. -m counts with memoized search instead (SudokuDLXSolver::countSolutions), which
+// needs neither colors nor multiplicities and cannot be combined with -a or -n.
+
+#include "sudoku.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+
+static int usage()
+{
+	std::cerr << "usage: exact_cover [-a] [-n limit] [-m] [file]" << std::endl;
+	return 2;
+}
+
+int main(int argc, char* argv[])
+{
+	bool printAll = false;
+	bool memoized = false;
+	unsigned long long limit = 0;
+	const char* path = nullptr;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "-a")
+			printAll = true;
+		else if (arg == "-n" && i + 1 < argc)
+		{
+			// 0 would mean no limit, so only positive counts are accepted
+			const char* text = argv[++i];
+			char* end = nullptr;
+			errno = 0;
+			limit = std::strtoull(text, &end, 10);
+			if (!std::isdigit(static_cast<unsigned char>(text[0])) || *end != '\0' || errno == ERANGE || limit == 0)
+				return usage();
+		}
+		else if (arg == "-m")
+			memoized = true;
+		else if (arg[0] != '-' && path == nullptr)
+			path = argv[i];
+		else
+			return usage();
+	}
+	if (memoized && (printAll || limit != 0))
+		return usage();
+
+	try
+	{
+		std::shared_ptr<const DLXTopology> topology;
+		if (path != nullptr)
+		{
+			std::ifstream file(path);
+			if (!file)
+			{
+				std::cerr << "cannot open " << path << std::endl;
+				return 1;
+			}
+			topology = DLXTopology::readDLX1(file);
+		}
+		else
+			topology = DLXTopology::readDLX1(std::cin);
+
+		SudokuDLXSolver solver(topology);
+		const unsigned long long count = memoized ? solver.countSolutions() : solver.enumerateRows([&](const std::vector<int>& rows) {
+			if (printAll)
+			{
+				for (int row : rows)
+				{
+					for (int node = topology->rowFirstNode[row]; node < topology->rowFirstNode[row + 1]; ++node)
+					{
+						std::cout << (node == topology->rowFirstNode[row] ? "" : " ")
+								  << topology->columnNames[topology->nodeColumn[node]];
+						if (!topology->nodeColor.empty() && topology->nodeColor[node] > 0)
+							std::cout << ':' << topology->colorNames[topology->nodeColor[node]];
+					}
+					std::cout << '\n';
+				}
+				std::cout << '\n';
+			}
+			return limit == 0 || --limit != 0;
+		});
+
+		std::cout << count << " solution" << (count == 1 ? "" : "s") << ", "
+				  << solver.getLastSearchStats().nodes << " nodes" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
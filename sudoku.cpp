@@ -32,330 +32,2520 @@
 #include <string>
 #include <stdexcept>
 #include <algorithm>
+#include <thread>
+#include <climits>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
-DLXNode::DLXNode() 
-	: left(nullptr), right(nullptr), up(nullptr), down(nullptr),
-	  column(nullptr), columnSize(0), rowData(3, 0) 
+// Software prefetching in the dancing loops. Build with -DSUDOKU_DLX_PREFETCH=0 to disable;
+// SUDOKU_DLX_PREFETCH_DISTANCE is how many rows ahead of the current one are requested.
+#ifndef SUDOKU_DLX_PREFETCH
+#define SUDOKU_DLX_PREFETCH 1
+#endif
+#ifndef SUDOKU_DLX_PREFETCH_DISTANCE
+#define SUDOKU_DLX_PREFETCH_DISTANCE 1
+#endif
+
+// DLX_PREFETCH asks for write access and is only for the per-solver links. The shared topology
+// is read by every thread, so DLX_PREFETCH_READ keeps its cache lines shared between cores.
+#if SUDOKU_DLX_PREFETCH && (defined(__GNUC__) || defined(__clang__))
+#define DLX_PREFETCH(address) __builtin_prefetch((address), 1, 3)
+#define DLX_PREFETCH_READ(address) __builtin_prefetch((address), 0, 3)
+#elif SUDOKU_DLX_PREFETCH && defined(_MSC_VER)
+#include <xmmintrin.h>
+#define DLX_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#define DLX_PREFETCH_READ(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define DLX_PREFETCH(address) ((void)0)
+#define DLX_PREFETCH_READ(address) ((void)0)
+#endif
+
+// USDT static tracepoints (provider "sudoku_dlx") for bpftrace/perf. Enabled automatically when
+// <sys/sdt.h> is available; an unattached probe is a single nop. SUDOKU_DLX_USDT_SEARCH=1 adds
+// a search__node probe per searchDLX() call, which is off by default as it sits in the hot path.
+#ifndef SUDOKU_DLX_USDT
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define SUDOKU_DLX_USDT 1
+#endif
+#endif
+#endif
+#ifndef SUDOKU_DLX_USDT
+#define SUDOKU_DLX_USDT 0
+#endif
+#ifndef SUDOKU_DLX_USDT_SEARCH
+#define SUDOKU_DLX_USDT_SEARCH 0
+#endif
+
+#if SUDOKU_DLX_USDT
+#include <sys/sdt.h>
+#define DLX_PROBE2(name, a, b) DTRACE_PROBE2(sudoku_dlx, name, a, b)
+#define DLX_PROBE3(name, a, b, c) DTRACE_PROBE3(sudoku_dlx, name, a, b, c)
+#else
+#define DLX_PROBE2(name, a, b) ((void)0)
+#define DLX_PROBE3(name, a, b, c) ((void)0)
+#endif
+
+#if SUDOKU_DLX_USDT && SUDOKU_DLX_USDT_SEARCH
+#define DLX_SEARCH_PROBE(depth, nodes) DLX_PROBE2(search__node, depth, nodes)
+#else
+#define DLX_SEARCH_PROBE(depth, nodes) ((void)0)
+#endif
+
+template <typename T>
+static size_t vectorBytes(const std::vector<T>& v)
+{
+	return v.capacity() * sizeof(T);
+}
+
+SudokuLayout SudokuLayout::single(int size)
+{
+	SudokuLayout layout = {};
+	layout.gridSize = size;
+	layout.height = size;
+	layout.width = size;
+	layout.grids.push_back({ 0, 0 });
+	return layout;
+}
+
+SudokuLayout SudokuLayout::latin(int order)
+{
+	SudokuLayout layout = single(order);
+	layout.latinSquare = true;
+	return layout;
+}
+
+SudokuLayout SudokuLayout::samurai()
+{
+	SudokuLayout layout = single(9);
+	layout.height = 21;
+	layout.width = 21;
+	layout.grids = { { 0, 0 }, { 0, 12 }, { 6, 6 }, { 12, 0 }, { 12, 12 } };
+	return layout;
+}
+
+SudokuLayout SudokuLayout::windoku()
+{
+	SudokuLayout layout = single(9);
+	for (int top : { 1, 5 })
+	{
+		for (int left : { 1, 5 })
+		{
+			ExtraRegion window = { {}, true };
+			for (int i = 0; i < 3; ++i)
+				for (int j = 0; j < 3; ++j)
+					window.cells.push_back({ top + i, left + j });
+			layout.extraRegions.push_back(window);
+		}
+	}
+	return layout;
+}
+
+SudokuLayout SudokuLayout::disjointGroups(int size)
+{
+	SudokuLayout layout = single(size);
+	const int blockSize = static_cast<int>(std::sqrt(size));
+	for (int position = 0; position < blockSize * blockSize; ++position)
+	{
+		ExtraRegion group = { {}, true };
+		for (int box = 0; box < blockSize * blockSize; ++box)
+			group.cells.push_back({ box / blockSize * blockSize + position / blockSize,
+									box % blockSize * blockSize + position % blockSize });
+		layout.extraRegions.push_back(group);
+	}
+	return layout;
+}
+
+DLXTopology::DLXTopology(int size)
+	: DLXTopology(SudokuLayout::single(size))
+{
+}
+
+DLXTopology::DLXTopology(const SudokuLayout& layout)
+	: gridSize(layout.gridSize)
+	, blockSize(layout.latinSquare ? 0 : static_cast<int>(std::sqrt(layout.gridSize)))
+	, height(layout.height)
+	, width(layout.width)
+	, cellCount(0)
+	, rowCount(0)
+	, columnCount(0)
+	, maxDepth(0)
+	, primaryColumnCount(0)
+	, rowWidth(0)
+	, constructionBytes(0)
+{
+	if (layout.latinSquare && gridSize < 1)
+		throw std::invalid_argument("Latin square order must be positive, but got: " + std::to_string(gridSize));
+	if (!layout.latinSquare && blockSize * blockSize != gridSize)
+		throw std::invalid_argument("Grid size must be a perfect square (e.g., 4, 9, 16, 25), but got: " + std::to_string(gridSize));
+	if (layout.grids.empty())
+		throw std::invalid_argument("Layout must contain at least one grid");
+
+	for (size_t g = 0; g < layout.grids.size(); ++g)
+	{
+		const GridPlacement& grid = layout.grids[g];
+		if (grid.top < 0 || grid.left < 0 || grid.top + gridSize > height || grid.left + gridSize > width)
+			throw std::invalid_argument("Grid " + std::to_string(g) + " at (" + std::to_string(grid.top) + ", " +
+				std::to_string(grid.left) + ") does not fit on the " + std::to_string(height) + "x" +
+				std::to_string(width) + " canvas");
+	}
+
+	// Number the puzzle cells in canvas order; a single grid maps every position to itself
+	cellIndex.assign(static_cast<size_t>(height) * width, -1);
+	for (const GridPlacement& grid : layout.grids)
+		for (int i = 0; i < gridSize; ++i)
+			for (int j = 0; j < gridSize; ++j)
+				cellIndex[(grid.top + i) * width + grid.left + j] = 0;
+	for (int& cell : cellIndex)
+		if (cell == 0)
+			cell = cellCount++;
+
+	// Every region must hold each digit exactly once: the rows of all grids, then their columns,
+	// then their boxes (Latin squares have none). A box shared by two grids is the same set of
+	// cells and is kept once.
+	std::vector<std::vector<int>> regions;
+	for (const GridPlacement& grid : layout.grids)
+	{
+		for (int i = 0; i < gridSize; ++i)
+		{
+			std::vector<int> region;
+			for (int j = 0; j < gridSize; ++j)
+				region.push_back(cellIndex[(grid.top + i) * width + grid.left + j]);
+			regions.push_back(region);
+		}
+	}
+	for (const GridPlacement& grid : layout.grids)
+	{
+		for (int j = 0; j < gridSize; ++j)
+		{
+			std::vector<int> region;
+			for (int i = 0; i < gridSize; ++i)
+				region.push_back(cellIndex[(grid.top + i) * width + grid.left + j]);
+			regions.push_back(region);
+		}
+	}
+	const size_t firstBox = regions.size();
+	for (const GridPlacement& grid : layout.grids)
+	{
+		for (int box = 0; box < gridSize && blockSize > 0; ++box)
+		{
+			std::vector<int> region;
+			const int top = grid.top + box / blockSize * blockSize;
+			const int left = grid.left + box % blockSize * blockSize;
+			for (int i = 0; i < blockSize; ++i)
+				for (int j = 0; j < blockSize; ++j)
+					region.push_back(cellIndex[(top + i) * width + left + j]);
+
+			if (std::find(regions.begin() + firstBox, regions.end(), region) == regions.end())
+				regions.push_back(region);
+		}
+	}
+
+	// Extra regions come last, primary before secondary so that the primary columns stay
+	// contiguous
+	int primaryRegions = static_cast<int>(regions.size());
+	for (bool primary : { true, false })
+	{
+		for (size_t r = 0; r < layout.extraRegions.size(); ++r)
+		{
+			const ExtraRegion& extra = layout.extraRegions[r];
+			if (extra.primary != primary)
+				continue;
+
+			const int size = static_cast<int>(extra.cells.size());
+			if (primary ? size != gridSize : size > gridSize)
+				throw std::invalid_argument("Extra region " + std::to_string(r) + " has " + std::to_string(size) +
+					" cells, but a " + (primary ? "primary" : "secondary") + " region needs " +
+					(primary ? "exactly " : "at most ") + std::to_string(gridSize));
+
+			std::vector<int> region;
+			for (const std::pair<int, int>& cell : extra.cells)
+			{
+				if (cell.first < 0 || cell.first >= height || cell.second < 0 || cell.second >= width ||
+					!isCell(cell.first, cell.second))
+					throw std::invalid_argument("Extra region " + std::to_string(r) + " contains (" +
+						std::to_string(cell.first) + ", " + std::to_string(cell.second) + "), which is not a puzzle cell");
+				region.push_back(cellIndex[cell.first * width + cell.second]);
+			}
+
+			std::sort(region.begin(), region.end());
+			if (std::adjacent_find(region.begin(), region.end()) != region.end())
+				throw std::invalid_argument("Extra region " + std::to_string(r) + " contains a cell twice");
+
+			regions.push_back(region);
+			if (primary)
+				primaryRegions++;
+		}
+	}
+
+	buildDLXLinkedList(regions, primaryRegions);
+	if (layout.exclusions != 0 || !layout.inequalities.empty())
+		buildConflicts(layout);
+	if (!layout.inequalities.empty() || !layout.parity.empty())
+		buildPrunedRows(layout);
+
+	// The region lists only live during construction
+	size_t regionBytes = vectorBytes(regions);
+	for (const std::vector<int>& region : regions)
+		regionBytes += vectorBytes(region);
+	constructionBytes = memoryBytes() + regionBytes;
+}
+
+void DLXTopology::buildDLXLinkedList(const std::vector<std::vector<int>>& regions, int primaryRegions)
+{
+	// Columns: one per puzzle cell, then one per (region, digit)
+	columnCount = cellCount + static_cast<int>(regions.size()) * gridSize;
+	primaryColumnCount = cellCount + primaryRegions * gridSize;
+	rowCount = cellCount * gridSize;
+	maxDepth = cellCount;
+
+	// Regions of each cell in ascending order, so that row nodes follow column order
+	std::vector<std::vector<int>> cellRegions(cellCount);
+	size_t rowNodes = cellCount;
+	for (size_t r = 0; r < regions.size(); ++r)
+	{
+		for (int cell : regions[r])
+			cellRegions[cell].push_back(static_cast<int>(r));
+		rowNodes += regions[r].size();
+	}
+
+	const size_t nodeCount = kFixedRowWidth + columnCount + rowNodes * gridSize;
+	nodeColumn.reserve(nodeCount);
+	nodeRow.reserve(nodeCount);
+	nodeLeft.reserve(nodeCount);
+	nodeRight.reserve(nodeCount);
+	rowData.reserve(rowCount);
+	rowFirstNode.reserve(rowCount + 1);
+
+	// Root header (0) and all Column Nodes. Vertical links are per solver and are built by
+	// SudokuDLXSolver::applyInitialConstraints() on every load.
+	for (int i = 0; i <= columnCount; ++i)
+	{
+		nodeColumn.push_back(i);
+		nodeRow.push_back(-1);
+		nodeLeft.push_back(i);
+		nodeRight.push_back(i);
+	}
+
+	// Pad so that row nodes start on a multiple of kFixedRowWidth (see rowWidth)
+	while (nodeColumn.size() % kFixedRowWidth != 0)
+	{
+		const int padding = static_cast<int>(nodeColumn.size());
+		nodeColumn.push_back(0);
+		nodeRow.push_back(-1);
+		nodeLeft.push_back(padding);
+		nodeRight.push_back(padding);
+	}
+
+	std::vector<int> cellPosition(cellCount);
+	for (int position = 0; position < height * width; ++position)
+		if (cellIndex[position] >= 0)
+			cellPosition[cellIndex[position]] = position;
+
+	bool uniformRows = true;
+
+	// Row cell * gridSize + value - 1 places value in cell: its cell column and one
+	// (region, value) column per region of the cell
+	for (int cell = 0; cell < cellCount; ++cell)
+	{
+		for (int value = 1; value <= gridSize; ++value)
+		{
+			const int row = static_cast<int>(rowData.size());
+			rowData.push_back({ value, cellPosition[cell] / width, cellPosition[cell] % width });
+
+			const int first = static_cast<int>(nodeColumn.size());
+			rowFirstNode.push_back(first);
+
+			nodeColumn.push_back(cell + 1);
+			for (int region : cellRegions[cell])
+				nodeColumn.push_back(cellCount + region * gridSize + value);
+
+			const int last = static_cast<int>(nodeColumn.size()) - 1;
+			for (int node = first; node <= last; ++node)
+			{
+				nodeRow.push_back(row);
+				nodeLeft.push_back(node == first ? last : node - 1);
+				nodeRight.push_back(node == last ? first : node + 1);
+			}
+			uniformRows = uniformRows && last - first + 1 == kFixedRowWidth;
+		}
+	}
+
+	rowFirstNode.push_back(static_cast<int>(nodeColumn.size()));
+	rowWidth = uniformRows ? kFixedRowWidth : 0;
+}
+
+DLXTopology::DLXTopology(std::vector<std::string> names, int primaryColumns,
+						 const std::vector<std::vector<int>>& options,
+						 const std::vector<std::vector<int>>& optionColors,
+						 const std::vector<std::pair<int, int>>& bounds)
+	: gridSize(0)
+	, blockSize(0)
+	, height(0)
+	, width(0)
+	, cellCount(0)
+	, rowCount(static_cast<int>(options.size()))
+	, columnCount(static_cast<int>(names.size()))
+	, maxDepth(primaryColumns)
+	, primaryColumnCount(primaryColumns)
+	, rowWidth(0)
+	, constructionBytes(0)
+	, columnNames(std::move(names))
+{
+	if (primaryColumns < 1 || primaryColumns > columnCount)
+		throw std::invalid_argument("Expected between 1 and " + std::to_string(columnCount) +
+			" primary columns, but got: " + std::to_string(primaryColumns));
+	columnNames.insert(columnNames.begin(), std::string());
+	if (!optionColors.empty() && optionColors.size() != options.size())
+		throw std::invalid_argument("Expected colors for " + std::to_string(options.size()) +
+			" options, but got: " + std::to_string(optionColors.size()));
+	if (!bounds.empty() && static_cast<int>(bounds.size()) != primaryColumns)
+		throw std::invalid_argument("Expected bounds for " + std::to_string(primaryColumns) +
+			" primary columns, but got: " + std::to_string(bounds.size()));
+
+	// Multiplicities are only stored when some column differs from exactly once, so that plain
+	// problems keep the exact cover search. A solution has at most max rows per column.
+	if (std::any_of(bounds.begin(), bounds.end(), [](const std::pair<int, int>& b) { return b.first != 1 || b.second != 1; }))
+	{
+		long long depth = 0;
+		columnLower.assign(columnCount + 1, 0);
+		columnUpper.assign(columnCount + 1, 0);
+		for (int col = 1; col <= primaryColumns; ++col)
+		{
+			const std::pair<int, int>& bound = bounds[col - 1];
+			if (bound.first < 0 || bound.second < 1 || bound.first > bound.second)
+				throw std::invalid_argument("Column " + std::to_string(col) + " needs 0 <= min <= max and max >= 1, but got: " +
+					std::to_string(bound.first) + ":" + std::to_string(bound.second));
+			columnLower[col] = bound.first;
+			columnUpper[col] = bound.second;
+			depth += bound.second;
+		}
+		maxDepth = static_cast<int>(std::max<long long>(primaryColumns, std::min<long long>(depth, rowCount)));
+	}
+
+	size_t nodeCount = kFixedRowWidth + columnCount;
+	for (const std::vector<int>& option : options)
+		nodeCount += option.size();
+	nodeColumn.reserve(nodeCount);
+	nodeRow.reserve(nodeCount);
+	nodeLeft.reserve(nodeCount);
+	nodeRight.reserve(nodeCount);
+	rowFirstNode.reserve(rowCount + 1);
+
+	for (int i = 0; i <= columnCount; ++i)
+	{
+		nodeColumn.push_back(i);
+		nodeRow.push_back(-1);
+		nodeLeft.push_back(i);
+		nodeRight.push_back(i);
+	}
+	while (nodeColumn.size() % kFixedRowWidth != 0)
+	{
+		const int padding = static_cast<int>(nodeColumn.size());
+		nodeColumn.push_back(0);
+		nodeRow.push_back(-1);
+		nodeLeft.push_back(padding);
+		nodeRight.push_back(padding);
+	}
+
+	// Options go straight into the node arrays, in input order
+	const bool colored = std::any_of(optionColors.begin(), optionColors.end(), [](const std::vector<int>& colors) {
+		return std::any_of(colors.begin(), colors.end(), [](int color) { return color != 0; });
+	});
+	if (colored)
+		nodeColor.assign(nodeColumn.size(), 0);
+	bool uniformRows = true;
+	std::vector<int> lastSeen(columnCount + 1, -1);
+	for (int row = 0; row < rowCount; ++row)
+	{
+		const std::vector<int>& option = options[row];
+		const int first = static_cast<int>(nodeColumn.size());
+		const int last = first + static_cast<int>(option.size()) - 1;
+		bool hasPrimary = false;
+		rowFirstNode.push_back(first);
+		if (colored && optionColors[row].size() != option.size())
+			throw std::invalid_argument("Option " + std::to_string(row) + " has " + std::to_string(option.size()) +
+				" columns, but " + std::to_string(optionColors[row].size()) + " colors");
+
+		for (size_t i = 0; i < option.size(); ++i)
+		{
+			const int col = option[i];
+			if (col < 1 || col > columnCount || lastSeen[col] == row)
+				throw std::invalid_argument("Option " + std::to_string(row) + " names column " +
+					std::to_string(col) + (lastSeen[col] == row ? " twice" : ", which does not exist"));
+
+			lastSeen[col] = row;
+			hasPrimary = hasPrimary || col <= primaryColumns;
+			const int node = first + static_cast<int>(i);
+			nodeColumn.push_back(col);
+			nodeRow.push_back(row);
+			nodeLeft.push_back(node == first ? last : node - 1);
+			nodeRight.push_back(node == last ? first : node + 1);
+			if (colored)
+			{
+				const int color = optionColors[row][i];
+				if (color < 0 || (color > 0 && col <= primaryColumns))
+					throw std::invalid_argument("Option " + std::to_string(row) + " gives column " + std::to_string(col) +
+						" the color " + std::to_string(color) + ", only secondary columns take colors above 0");
+				nodeColor.push_back(color);
+			}
+		}
+		if (!hasPrimary)
+			throw std::invalid_argument("Option " + std::to_string(row) + " has no primary column");
+		uniformRows = uniformRows && last - first + 1 == kFixedRowWidth;
+	}
+
+	rowFirstNode.push_back(static_cast<int>(nodeColumn.size()));
+	// The fixed-width cover loops do not look at colors
+	rowWidth = uniformRows && rowCount > 0 && !colored ? kFixedRowWidth : 0;
+	constructionBytes = memoryBytes() + vectorBytes(lastSeen);
+}
+
+// Non-negative decimal count of a DLX3 bound
+static bool parseBound(const std::string& text, int& value)
+{
+	if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos)
+		return false;
+	value = std::stoi(text);
+	return true;
+}
+
+std::shared_ptr<const DLXTopology> DLXTopology::readDLX1(std::istream& in)
+{
+	std::vector<std::string> names;
+	std::map<std::string, int> columnOf;
+	std::vector<std::vector<int>> options;
+	std::vector<std::vector<int>> optionColors;
+	std::map<std::string, int> colorOf;
+	std::vector<std::string> colorNames(1);
+	std::vector<std::pair<int, int>> bounds;
+	int primaryColumns = -1;
+
+	std::string line;
+	for (int lineNumber = 1; std::getline(in, line); ++lineNumber)
+	{
+		if (!line.empty() && line[0] == '|')
+			continue;
+
+		std::istringstream tokens(line);
+		std::string token;
+		const std::string where = " on line " + std::to_string(lineNumber);
+
+		if (names.empty())
+		{
+			while (tokens >> token)
+			{
+				if (token == "|")
+				{
+					if (primaryColumns >= 0)
+						throw std::invalid_argument("Second '|' in the item line" + where);
+					primaryColumns = static_cast<int>(names.size());
+					continue;
+				}
+
+				// DLX3 multiplicities: min:max|item, or count|item for exactly count
+				std::pair<int, int> bound(1, 1);
+				const size_t bar = token.find('|');
+				if (bar != std::string::npos)
+				{
+					const std::string spec = token.substr(0, bar);
+					const size_t colon = spec.find(':');
+					token.erase(0, bar + 1);
+					if (primaryColumns >= 0)
+						throw std::invalid_argument("Secondary item " + token + " cannot have bounds" + where);
+					if (token.empty() || !parseBound(spec.substr(0, colon), bound.first) ||
+						!parseBound(colon == std::string::npos ? spec : spec.substr(colon + 1), bound.second))
+						throw std::invalid_argument("Malformed bounds " + spec + "|" + token + where);
+					if (colon == std::string::npos)
+						bound.first = bound.second;
+				}
+				if (primaryColumns < 0)
+					bounds.push_back(bound);
+				if (!columnOf.insert({ token, static_cast<int>(names.size()) + 1 }).second)
+					throw std::invalid_argument("Item " + token + " is declared twice" + where);
+				names.push_back(token);
+			}
+			if (names.empty())
+				continue;
+			if (primaryColumns < 0)
+				primaryColumns = static_cast<int>(names.size());
+			if (primaryColumns == 0)
+				throw std::invalid_argument("No primary items" + where);
+			continue;
+		}
+
+		std::vector<int> option;
+		std::vector<int> colors;
+		while (tokens >> token)
+		{
+			// DLX2 colors: item:color, unless the whole token is a declared item name
+			std::map<std::string, int>::const_iterator column = columnOf.find(token);
+			int color = 0;
+			const size_t colon = token.find(':');
+			if (column == columnOf.end() && colon != std::string::npos)
+			{
+				const std::string colorName = token.substr(colon + 1);
+				token.erase(colon);
+				column = columnOf.find(token);
+				if (colorName.empty())
+					throw std::invalid_argument("Empty color for item " + token + where);
+				if (column != columnOf.end() && column->second <= primaryColumns)
+					throw std::invalid_argument("Primary item " + token + " cannot have a color" + where);
+
+				color = colorOf.insert({ colorName, static_cast<int>(colorNames.size()) }).first->second;
+				if (color == static_cast<int>(colorNames.size()))
+					colorNames.push_back(colorName);
+			}
+			if (column == columnOf.end())
+				throw std::invalid_argument("Unknown item " + token + where);
+			if (std::find(option.begin(), option.end(), column->second) != option.end())
+				throw std::invalid_argument("Item " + token + " appears twice in an option" + where);
+			option.push_back(column->second);
+			colors.push_back(color);
+		}
+		if (option.empty())
+			continue;
+		if (std::none_of(option.begin(), option.end(), [&](int col) { return col <= primaryColumns; }))
+			throw std::invalid_argument("Option without a primary item" + where);
+		options.push_back(option);
+		optionColors.push_back(colors);
+	}
+
+	if (names.empty())
+		throw std::invalid_argument("Missing item line");
+	if (colorNames.size() == 1)
+		optionColors.clear();
+	std::shared_ptr<DLXTopology> topology =
+		std::make_shared<DLXTopology>(std::move(names), primaryColumns, options, optionColors, bounds);
+	topology->colorNames = std::move(colorNames);
+	return topology;
+}
+
+bool DLXTopology::sharesColumn(int rowA, int rowB) const
+{
+	for (int a = rowFirstNode[rowA]; a < rowFirstNode[rowA + 1]; ++a)
+		for (int b = rowFirstNode[rowB]; b < rowFirstNode[rowB + 1]; ++b)
+			if (nodeColumn[a] == nodeColumn[b])
+				return true;
+	return false;
+}
+
+int DLXTopology::layoutCell(const std::pair<int, int>& cell, const char* what) const
+{
+	if (cell.first < 0 || cell.first >= height || cell.second < 0 || cell.second >= width ||
+		!isCell(cell.first, cell.second))
+		throw std::invalid_argument(std::string(what) + " refers to (" + std::to_string(cell.first) + ", " +
+			std::to_string(cell.second) + "), which is not a puzzle cell");
+	return cellIndex[cell.first * width + cell.second];
+}
+
+void DLXTopology::buildConflicts(const SudokuLayout& layout)
+{
+	const int exclusions = layout.exclusions;
+
+	// Neighbour offsets whose cells may not hold the same digit
+	std::vector<std::pair<int, int>> sameDigit;
+	if (exclusions & kAntiKnight)
+		sameDigit.insert(sameDigit.end(), { { -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 }, { 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 } });
+	if (exclusions & kAntiKing)
+		sameDigit.insert(sameDigit.end(), { { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } });
+	const std::pair<int, int> orthogonal[] = { { -1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 0 } };
+
+	// Pairs that already share a column exclude each other anyway and are left out
+	std::vector<std::vector<int>> conflicts(rowCount);
+	for (int i = 0; i < height; ++i)
+	{
+		for (int j = 0; j < width; ++j)
+		{
+			if (!isCell(i, j))
+				continue;
+
+			for (int value = 1; value <= gridSize; ++value)
+			{
+				const int row = rowIndex(value, i, j);
+				std::vector<int>& excluded = conflicts[row];
+
+				for (const std::pair<int, int>& offset : sameDigit)
+				{
+					const int r = i + offset.first, c = j + offset.second;
+					if (r >= 0 && r < height && c >= 0 && c < width && isCell(r, c))
+						excluded.push_back(rowIndex(value, r, c));
+				}
+				for (int n = 0; n < 4 && (exclusions & kNonConsecutive); ++n)
+				{
+					const int r = i + orthogonal[n].first, c = j + orthogonal[n].second;
+					if (r < 0 || r >= height || c < 0 || c >= width || !isCell(r, c))
+						continue;
+					if (value > 1)
+						excluded.push_back(rowIndex(value - 1, r, c));
+					if (value < gridSize)
+						excluded.push_back(rowIndex(value + 1, r, c));
+				}
+
+			}
+		}
+	}
+
+	// smaller = v excludes larger <= v, in both directions
+	for (const Inequality& relation : layout.inequalities)
+	{
+		const int smaller = layoutCell(relation.smaller, "Inequality");
+		const int larger = layoutCell(relation.larger, "Inequality");
+		if (smaller == larger)
+			throw std::invalid_argument("Inequality between (" + std::to_string(relation.smaller.first) + ", " +
+				std::to_string(relation.smaller.second) + ") and itself");
+
+		inequalityCells.push_back(smaller);
+		inequalityCells.push_back(larger);
+		for (int value = 1; value <= gridSize; ++value)
+		{
+			for (int other = 1; other <= value; ++other)
+			{
+				conflicts[smaller * gridSize + value - 1].push_back(larger * gridSize + other - 1);
+				conflicts[larger * gridSize + other - 1].push_back(smaller * gridSize + value - 1);
+			}
+		}
+	}
+
+	for (int row = 0; row < rowCount; ++row)
+	{
+		std::vector<int>& excluded = conflicts[row];
+		std::sort(excluded.begin(), excluded.end());
+		excluded.erase(std::unique(excluded.begin(), excluded.end()), excluded.end());
+		excluded.erase(std::remove_if(excluded.begin(), excluded.end(),
+			[&](int other) { return sharesColumn(row, other); }), excluded.end());
+	}
+
+	conflictStart.reserve(rowCount + 1);
+	conflictStart.push_back(0);
+	for (const std::vector<int>& excluded : conflicts)
+	{
+		conflictRows.insert(conflictRows.end(), excluded.begin(), excluded.end());
+		conflictStart.push_back(static_cast<int>(conflictRows.size()));
+	}
+}
+
+void DLXTopology::buildPrunedRows(const SudokuLayout& layout)
+{
+	std::vector<int> lowest(cellCount, 1);
+	std::vector<int> highest(cellCount, gridSize);
+
+	for (const ParityCell& restriction : layout.parity)
+	{
+		const int cell = layoutCell(restriction.cell, "Parity restriction");
+		for (int value = 1; value <= gridSize; ++value)
+			if ((value % 2 == 0) != restriction.even)
+				prunedRows.push_back(cell * gridSize + value - 1);
+	}
+
+	// Bounds from chains: a cell with k cells in a chain below it is at least k + 1, one with
+	// k above it at most gridSize - k. Relax until stable; the bounds are capped, so a cycle
+	// ends with an empty range instead of looping.
+	for (bool changed = true; changed; )
+	{
+		changed = false;
+		for (const Inequality& relation : layout.inequalities)
+		{
+			const int smaller = cellIndex[relation.smaller.first * width + relation.smaller.second];
+			const int larger = cellIndex[relation.larger.first * width + relation.larger.second];
+			if (lowest[larger] < std::min(lowest[smaller] + 1, gridSize + 1))
+			{
+				lowest[larger] = std::min(lowest[smaller] + 1, gridSize + 1);
+				changed = true;
+			}
+			if (highest[smaller] > std::max(highest[larger] - 1, 0))
+			{
+				highest[smaller] = std::max(highest[larger] - 1, 0);
+				changed = true;
+			}
+		}
+	}
+
+	for (int cell = 0; cell < cellCount; ++cell)
+		for (int value = 1; value <= gridSize; ++value)
+			if (value < lowest[cell] || value > highest[cell])
+				prunedRows.push_back(cell * gridSize + value - 1);
+
+	std::sort(prunedRows.begin(), prunedRows.end());
+	prunedRows.erase(std::unique(prunedRows.begin(), prunedRows.end()), prunedRows.end());
+}
+
+size_t DLXTopology::memoryBytes() const
+{
+	return sizeof(DLXTopology) + vectorBytes(nodeColumn) + vectorBytes(nodeRow) +
+		vectorBytes(nodeLeft) + vectorBytes(nodeRight) + vectorBytes(rowData) + vectorBytes(rowFirstNode) +
+		vectorBytes(cellIndex) + vectorBytes(conflictStart) + vectorBytes(conflictRows) +
+		vectorBytes(prunedRows) + vectorBytes(inequalityCells) + vectorBytes(nodeColor) + vectorBytes(columnLower) + vectorBytes(columnUpper);
+}
+
+std::shared_ptr<const DLXTopology> DLXTopology::forGridSize(int size)
+{
+	static std::mutex cacheMutex;
+	static std::map<int, std::weak_ptr<const DLXTopology>> cache;
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	std::shared_ptr<const DLXTopology> topology = cache[size].lock();
+	if (!topology)
+	{
+		topology = std::make_shared<const DLXTopology>(size);
+		cache[size] = topology;
+	}
+	return topology;
+}
+
+SudokuDLXSolver::SudokuDLXSolver(int size)
+	: SudokuDLXSolver(DLXTopology::forGridSize(size))
+{
+}
+
+SudokuDLXSolver::SudokuDLXSolver(const SudokuLayout& layout)
+	: SudokuDLXSolver(std::make_shared<const DLXTopology>(layout))
+{
+}
+
+SudokuDLXSolver::SudokuDLXSolver(std::shared_ptr<const DLXTopology> sharedTopology)
+	: gridSize(sharedTopology->gridSize)
+	, blockSize(sharedTopology->blockSize)
+	, height(sharedTopology->height)
+	, width(sharedTopology->width)
+	, cellCount(sharedTopology->cellCount)
+	, topology(std::move(sharedTopology))
+	, solution(topology->maxDepth, -1)
+	, fixedClues(topology->maxDepth, -1)
+	, solutionCount(0)
+	, clueCount(0)
+	, givenCount(0)
+	, rowVisitor(nullptr)
+	, visitedSolutions(0)
+	, branchIndex(topology->maxDepth + (topology->columnUpper.empty() ? 0 : topology->primaryColumnCount), 0)
+	, branchCount(branchIndex.size(), 0)
+	, progressInterval(0)
+	, progressCountdown(0)
+	, hybridThreshold(0)
+	, searchNodes(0)
+	, solutionBytes(0)
+	, lastSolveMemory()
+	, peakMemory()
+	, unwindOnAbort(true)
+	, loaded(false)
+	, neverLoaded(true)
+{
+}
+
+static inline void unlinkNode(DLXLink* link, DLXColumn* column, const int* nodeColumn, int node)
+{
+	link[link[node].down].up = link[node].up;
+	link[link[node].up].down = link[node].down;
+	column[nodeColumn[node]].size--;
+}
+
+static inline void relinkNode(DLXLink* link, DLXColumn* column, const int* nodeColumn, int node)
+{
+	column[nodeColumn[node]].size++;
+	link[link[node].down].up = node;
+	link[link[node].up].down = node;
+}
+
+#if SUDOKU_DLX_PREFETCH
+// Requests the links and columns of the row group `node` belongs to. The walk that finds
+// `node` runs SUDOKU_DLX_PREFETCH_DISTANCE rows ahead; the column's own vertical list is
+// never modified while it is being covered or uncovered, so that walk stays valid.
+static inline void prefetchRow(const DLXLink* link, const int* nodeColumn, int node)
+{
+	DLX_PREFETCH(&link[node & ~(kFixedRowWidth - 1)]);
+	DLX_PREFETCH_READ(&nodeColumn[node & ~(kFixedRowWidth - 1)]);
+}
+
+static inline int prefetchStart(const DLXLink* link, int col, bool down)
+{
+	int ahead = col;
+	for (int i = 0; i < SUDOKU_DLX_PREFETCH_DISTANCE; ++i)
+		ahead = down ? link[ahead].down : link[ahead].up;
+	return ahead;
+}
+#endif
+
+void SudokuDLXSolver::coverColumn(int col)
+{
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const int* const nodeColumn = topology->nodeColumn.data();
+
+	column[column[col].left].right = column[col].right;
+	column[column[col].right].left = column[col].left;
+
+#if SUDOKU_DLX_PREFETCH
+	int ahead = prefetchStart(link, col, true);
+#endif
+	if (topology->rowWidth == kFixedRowWidth)
+	{
+		// Rows are aligned groups of four nodes, so the siblings of a node are node ^ 1..3:
+		// no loads and no dependency from one sibling to the next
+		for (int node = link[col].down; node != col; node = link[node].down)
+		{
+#if SUDOKU_DLX_PREFETCH
+			ahead = link[ahead].down;
+			prefetchRow(link, nodeColumn, ahead);
+#endif
+			unlinkNode(link, column, nodeColumn, node ^ 1);
+			unlinkNode(link, column, nodeColumn, node ^ 2);
+			unlinkNode(link, column, nodeColumn, node ^ 3);
+		}
+		return;
+	}
+
+	// Purified nodes (color -1) stay linked so that unpurify() can find them again
+	const int* const right = topology->nodeRight.data();
+	const int* const color = nodeColor.empty() ? nullptr : nodeColor.data();
+	for (int node = link[col].down; node != col; node = link[node].down)
+	{
+#if SUDOKU_DLX_PREFETCH
+		ahead = link[ahead].down;
+		DLX_PREFETCH(&link[right[ahead]]);
+#endif
+		for (int temp = right[node]; temp != node; temp = right[temp])
+			if (color == nullptr || color[temp] >= 0)
+				unlinkNode(link, column, nodeColumn, temp);
+	}
+}
+
+void SudokuDLXSolver::uncoverColumn(int col)
+{
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const int* const nodeColumn = topology->nodeColumn.data();
+
+#if SUDOKU_DLX_PREFETCH
+	int ahead = prefetchStart(link, col, false);
+#endif
+	if (topology->rowWidth == kFixedRowWidth)
+	{
+		for (int node = link[col].up; node != col; node = link[node].up)
+		{
+#if SUDOKU_DLX_PREFETCH
+			ahead = link[ahead].up;
+			prefetchRow(link, nodeColumn, ahead);
+#endif
+			relinkNode(link, column, nodeColumn, node ^ 3);
+			relinkNode(link, column, nodeColumn, node ^ 2);
+			relinkNode(link, column, nodeColumn, node ^ 1);
+		}
+	}
+	else
+	{
+		const int* const left = topology->nodeLeft.data();
+		const int* const color = nodeColor.empty() ? nullptr : nodeColor.data();
+		for (int node = link[col].up; node != col; node = link[node].up)
+		{
+#if SUDOKU_DLX_PREFETCH
+			ahead = link[ahead].up;
+			DLX_PREFETCH(&link[left[ahead]]);
+#endif
+			for (int temp = left[node]; temp != node; temp = left[temp])
+				if (color == nullptr || color[temp] >= 0)
+					relinkNode(link, column, nodeColumn, temp);
+		}
+	}
+
+	column[column[col].left].right = col;
+	column[column[col].right].left = col;
+}
+
+void SudokuDLXSolver::coverSiblings(int node)
+{
+	const DLXTopology& topo = *topology;
+	if (topo.rowWidth == kFixedRowWidth)
+	{
+		coverColumn(topo.nodeColumn[node ^ 1]);
+		coverColumn(topo.nodeColumn[node ^ 2]);
+		coverColumn(topo.nodeColumn[node ^ 3]);
+		return;
+	}
+
+	// Knuth's commit: a colored node purifies its secondary column instead of covering it, and a
+	// node already purified by an earlier choice of the same color needs nothing at all
+	for (int temp = topo.nodeRight[node]; temp != node; temp = topo.nodeRight[temp])
+	{
+		if (nodeColor.empty() || nodeColor[temp] == 0)
+			coverColumn(topo.nodeColumn[temp]);
+		else if (nodeColor[temp] > 0)
+			purify(temp);
+	}
+}
+
+void SudokuDLXSolver::uncoverSiblings(int node)
+{
+	const DLXTopology& topo = *topology;
+	if (topo.rowWidth == kFixedRowWidth)
+	{
+		uncoverColumn(topo.nodeColumn[node ^ 3]);
+		uncoverColumn(topo.nodeColumn[node ^ 2]);
+		uncoverColumn(topo.nodeColumn[node ^ 1]);
+		return;
+	}
+
+	for (int temp = topo.nodeLeft[node]; temp != node; temp = topo.nodeLeft[temp])
+	{
+		if (nodeColor.empty() || nodeColor[temp] == 0)
+			uncoverColumn(topo.nodeColumn[temp]);
+		else if (nodeColor[temp] > 0)
+			unpurify(temp);
+	}
+}
+
+void SudokuDLXSolver::purify(int node)
+{
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const int* const nodeColumn = topology->nodeColumn.data();
+	const int* const right = topology->nodeRight.data();
+	int* const color = nodeColor.data();
+	const int col = nodeColumn[node];
+	const int shade = color[node];
+
+	// Rows of the same color stay and are marked -1, every other row using the column is hidden
+	for (int other = link[col].down; other != col; other = link[other].down)
+	{
+		if (other == node)
+			continue;
+		if (color[other] == shade)
+		{
+			color[other] = -1;
+			continue;
+		}
+		for (int temp = right[other]; temp != other; temp = right[temp])
+			if (color[temp] >= 0)
+				unlinkNode(link, column, nodeColumn, temp);
+	}
+}
+
+void SudokuDLXSolver::unpurify(int node)
+{
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const int* const nodeColumn = topology->nodeColumn.data();
+	const int* const left = topology->nodeLeft.data();
+	int* const color = nodeColor.data();
+	const int col = nodeColumn[node];
+	const int shade = color[node];
+
+	for (int other = link[col].up; other != col; other = link[other].up)
+	{
+		if (other == node)
+			continue;
+		if (color[other] < 0)
+		{
+			color[other] = shade;
+			continue;
+		}
+		for (int temp = left[other]; temp != other; temp = left[temp])
+			if (color[temp] >= 0)
+				relinkNode(link, column, nodeColumn, temp);
+	}
+}
+
+void SudokuDLXSolver::coverRow(int row)
+{
+	coverColumn(topology->nodeColumn[row]);
+	coverSiblings(row);
+}
+
+void SudokuDLXSolver::uncoverRow(int row)
+{
+	uncoverSiblings(row);
+	uncoverColumn(topology->nodeColumn[row]);
+}
+
+void SudokuDLXSolver::searchDLX(int k, int searchLimit, std::vector<std::vector<std::vector<int>>>& solutions)
+{
+	if (solutionCount >= searchLimit)
+		return;
+
+	searchNodes++;
+	DLX_SEARCH_PROBE(k, searchNodes);
+	if (progressInterval != 0 && --progressCountdown == 0)
+		reportProgress(k);
+
+	const int rootHeader = 0;
+	if (columns[rootHeader].right == rootHeader)
+	{
+		recordSolution(k, searchLimit, solutions);
+		return;
+	}
+
+	// Select column with minimum size (heuristic)
+	int col = columns[rootHeader].right;
+	int activeColumns = 1;
+	for (int temp = columns[col].right; temp != rootHeader; temp = columns[temp].right, activeColumns++)
+		if (columns[temp].size < columns[col].size)
+			col = temp;
+
+	if (activeColumns <= hybridThreshold)
+	{
+		if (columns[col].size == 0)
+			return;
+
+		exportResidual();
+		searchBitboard((activeColumns == 64) ? ~0ULL : ((1ULL << activeColumns) - 1), k, searchLimit, solutions);
+		return;
+	}
+
+	coverColumn(col);
+	branchIndex[k] = 0;
+	branchCount[k] = columns[col].size;
+
+	// Exclusion rules and propagators need the covered-column flags to tell which rows are
+	// still live
+	const bool trackRows = tracksRows();
+	for (int temp = links[col].down; temp != col; temp = links[temp].down, branchIndex[k]++)
+	{
+		solution[k] = temp;
+		coverSiblings(temp);
+
+		if (trackRows)
+		{
+			const int row = topology->nodeRow[temp];
+			markRow(row, true);
+			const int hidden = hideConflicts(row);
+			if (propagate(row))
+				searchDLX(k + 1, searchLimit, solutions);
+			if (solutionCount < searchLimit || unwindOnAbort)
+			{
+				unhideConflicts(hidden);
+				markRow(row, false);
+			}
+		}
+		else
+			searchDLX(k + 1, searchLimit, solutions);
+
+		// Once the limit is reached stop at once: either skip the remaining rows and only undo
+		// what this frame covered, or, when the links are reset before the next use, undo nothing
+		const bool limitReached = solutionCount >= searchLimit;
+		if (limitReached && !unwindOnAbort)
+			return;
+
+		solution[k] = -1;
+		uncoverSiblings(temp);
+		if (limitReached)
+			break;
+	}
+
+	uncoverColumn(col);
+}
+
+static inline int lowestBit(std::uint64_t mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+void SudokuDLXSolver::exportResidual()
+{
+	const DLXTopology& topo = *topology;
+	const int rootHeader = 0;
+
+	int bit = 0;
+	for (int col = columns[rootHeader].right; col != rootHeader; col = columns[col].right)
+		residual.columnBit[col] = bit++;
+
+	residual.rowMask.clear();
+	residual.rowNode.clear();
+	residual.columnStart.assign(bit + 1, 0);
+
+	// Every live row is linked into all of its columns, so take it only from its lowest bit
+	for (int col = columns[rootHeader].right; col != rootHeader; col = columns[col].right)
+	{
+		const int colBit = residual.columnBit[col];
+		for (int node = links[col].down; node != col; node = links[node].down)
+		{
+			std::uint64_t mask = 1ULL << colBit;
+			bool lowest = true;
+			for (int temp = topo.nodeRight[node]; temp != node; temp = topo.nodeRight[temp])
+			{
+				const int tempBit = residual.columnBit[topo.nodeColumn[temp]];
+				lowest = lowest && tempBit > colBit;
+				mask |= 1ULL << tempBit;
+			}
+			if (!lowest)
+				continue;
+
+			residual.rowMask.push_back(mask);
+			residual.rowNode.push_back(node);
+			for (std::uint64_t m = mask; m != 0; m &= m - 1)
+				residual.columnStart[lowestBit(m) + 1]++;
+		}
+	}
+
+	for (int i = 0; i < bit; ++i)
+		residual.columnStart[i + 1] += residual.columnStart[i];
+
+	residual.columnRows.resize(residual.columnStart[bit]);
+	std::vector<int> fill(residual.columnStart.begin(), residual.columnStart.end() - 1);
+	for (int row = 0; row < static_cast<int>(residual.rowMask.size()); ++row)
+		for (std::uint64_t m = residual.rowMask[row]; m != 0; m &= m - 1)
+			residual.columnRows[fill[lowestBit(m)]++] = row;
+}
+
+void SudokuDLXSolver::searchBitboard(std::uint64_t remaining, int k, int searchLimit,
+									 std::vector<std::vector<std::vector<int>>>& solutions)
+{
+	if (solutionCount >= searchLimit)
+		return;
+
+	searchNodes++;
+	if (remaining == 0)
+	{
+		recordSolution(k, searchLimit, solutions);
+		return;
+	}
+
+	const std::uint64_t* const rowMask = residual.rowMask.data();
+	const int* const columnRows = residual.columnRows.data();
+	const int* const columnStart = residual.columnStart.data();
+
+	// A row is still available while all of its columns are uncovered
+	int best = -1;
+	int bestCount = INT_MAX;
+	for (std::uint64_t m = remaining; m != 0; m &= m - 1)
+	{
+		const int bit = lowestBit(m);
+		int count = 0;
+		for (int i = columnStart[bit]; i < columnStart[bit + 1]; ++i)
+			count += (rowMask[columnRows[i]] & ~remaining) == 0;
+
+		if (count < bestCount)
+		{
+			best = bit;
+			bestCount = count;
+			if (count == 0)
+				return;
+		}
+	}
+
+	for (int i = columnStart[best]; i < columnStart[best + 1]; ++i)
+	{
+		const std::uint64_t mask = rowMask[columnRows[i]];
+		if ((mask & ~remaining) != 0)
+			continue;
+
+		solution[k] = residual.rowNode[columnRows[i]];
+		searchBitboard(remaining & ~mask, k + 1, searchLimit, solutions);
+	}
+	solution[k] = -1;
+}
+
+void SudokuDLXSolver::setHybridThreshold(int columns)
+{
+	if (columns < 0 || columns > 64)
+		throw std::invalid_argument("Hybrid threshold must be between 0 and 64 columns, but got: " + std::to_string(columns));
+	if (columns > 0 && topology->primaryColumnCount != topology->columnCount)
+		throw std::invalid_argument("Hybrid mode cannot track secondary columns (secondary extra regions)");
+	if (columns > 0 && !topology->conflictRows.empty())
+		throw std::invalid_argument("Hybrid mode cannot apply exclusion rules");
+	if (columns > 0 && propagator)
+		throw std::invalid_argument("Hybrid mode cannot run a propagator");
+	if (columns > 0 && !topology->columnUpper.empty())
+		throw std::invalid_argument("Hybrid mode cannot count column multiplicities");
+
+	hybridThreshold = columns;
+	residual.columnBit.assign(topology->columnCount + 1, 0);
+}
+
+void SudokuDLXSolver::reportProgress(int depth)
+{
+	progressCountdown = progressInterval;
+
+	double fraction = 0.0;
+	double subtree = 1.0;
+	for (int i = 0; i < depth; ++i)
+	{
+		subtree /= branchCount[i];
+		fraction += branchIndex[i] * subtree;
+	}
+	progressCallback(fraction);
+}
+
+void SudokuDLXSolver::setProgressCallback(std::function<void(double)> callback, unsigned long long interval)
+{
+	progressCallback = std::move(callback);
+	progressInterval = progressCallback ? std::max(1ULL, interval) : 0;
+	progressCountdown = progressInterval;
+}
+
+void SudokuDLXSolver::setPropagator(std::function<bool(PropagationContext&)> newPropagator)
+{
+	if (newPropagator && hybridThreshold > 0)
+		throw std::invalid_argument("Hybrid mode cannot run a propagator");
+	if (newPropagator && !topology->columnUpper.empty())
+		throw std::invalid_argument("Propagators cannot run on a topology with column multiplicities");
+
+	// Placements made before row tracking started hid nothing. Once started, the hide trail is
+	// kept until the next load(), even if the propagator is removed again.
+	propagator = std::move(newPropagator);
+	if (tracksRows() && clueHidden.empty())
+	{
+		hiddenRows.reserve(topology->rowCount);
+		clueHidden.assign(topology->maxDepth, 0);
+	}
+}
+
+bool SudokuDLXSolver::tracksRows() const
+{
+	return !topology->conflictRows.empty() || propagator;
+}
+
+bool SudokuDLXSolver::propagate(int row)
+{
+	if (!propagator)
+		return true;
+
+	PropagationContext context(*this, row);
+	return propagator(context);
+}
+
+PropagationContext::PropagationContext(SudokuDLXSolver& owner, int exactCoverRow)
+	: solver(owner)
+	, lastRow(-1)
+	, lastCol(-1)
+	, lastValue(0)
+{
+	if (exactCoverRow >= 0 && !solver.topology->rowData.empty())
+	{
+		const DLXRowData& data = solver.topology->rowData[exactCoverRow];
+		lastRow = data.row;
+		lastCol = data.col;
+		lastValue = data.value;
+	}
+}
+
+int PropagationContext::getGridSize() const
+{
+	return solver.gridSize;
+}
+
+int PropagationContext::getHeight() const
+{
+	return solver.height;
+}
+
+int PropagationContext::getWidth() const
+{
+	return solver.width;
+}
+
+int PropagationContext::valueAt(int row, int col) const
+{
+	const DLXTopology& topo = *solver.topology;
+	if (row < 0 || row >= topo.height || col < 0 || col >= topo.width || !topo.isCell(row, col))
+		return 0;
+
+	const int placed = solver.placedRow[topo.cellIndex[row * topo.width + col]];
+	return placed < 0 ? 0 : topo.rowData[placed].value;
+}
+
+bool PropagationContext::isCandidate(int value, int row, int col) const
+{
+	const DLXTopology& topo = *solver.topology;
+	if (row < 0 || row >= topo.height || col < 0 || col >= topo.width || value < 1 || value > topo.gridSize ||
+		!topo.isCell(row, col))
+		return false;
+
+	const int exactCoverRow = topo.rowIndex(value, row, col);
+	return solver.placedRow[exactCoverRow / topo.gridSize] == exactCoverRow || solver.isRowAvailable(exactCoverRow);
+}
+
+void PropagationContext::eliminate(int value, int row, int col)
+{
+	const DLXTopology& topo = *solver.topology;
+	if (row < 0 || row >= topo.height || col < 0 || col >= topo.width || value < 1 || value > topo.gridSize ||
+		!topo.isCell(row, col))
+		return;
+
+	const int exactCoverRow = topo.rowIndex(value, row, col);
+	if (solver.isRowAvailable(exactCoverRow))
+		solver.hideRow(exactCoverRow);
+}
+
+bool SudokuDLXSolver::isRowAvailable(int row) const
+{
+	// A row has been removed exactly when it was eliminated before search, hidden by an
+	// exclusion rule or one of its columns is covered
+	if (rowExcluded[row] || rowHidden[row])
+		return false;
+
+	const DLXTopology& topo = *topology;
+	for (int node = topo.rowFirstNode[row]; node < topo.rowFirstNode[row + 1]; ++node)
+		if (columnCovered[topo.nodeColumn[node]])
+			return false;
+	return true;
+}
+
+void SudokuDLXSolver::markRow(int row, bool covered)
+{
+	const DLXTopology& topo = *topology;
+	for (int node = topo.rowFirstNode[row]; node < topo.rowFirstNode[row + 1]; ++node)
+		columnCovered[topo.nodeColumn[node]] = covered;
+	if (topo.gridSize > 0)
+		placedRow[row / topo.gridSize] = covered ? row : -1;
+}
+
+void SudokuDLXSolver::hideRow(int row)
+{
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const DLXTopology& topo = *topology;
+
+	rowHidden[row] = 1;
+	hiddenRows.push_back(row);
+	for (int node = topo.rowFirstNode[row]; node < topo.rowFirstNode[row + 1]; ++node)
+		unlinkNode(link, column, topo.nodeColumn.data(), node);
+}
+
+int SudokuDLXSolver::hideConflicts(int row)
+{
+	// Unlink every still live row that the exclusion rules forbid next to `row`, then whatever
+	// the inequality bounds rule out; returns the trail marker for unhideConflicts(). Needs
+	// columnCovered to be current.
+	const DLXTopology& topo = *topology;
+	const int marker = static_cast<int>(hiddenRows.size());
+
+	if (!topo.conflictRows.empty())
+		for (int i = topo.conflictStart[row]; i < topo.conflictStart[row + 1]; ++i)
+			if (isRowAvailable(topo.conflictRows[i]))
+				hideRow(topo.conflictRows[i]);
+	if (!topo.inequalityCells.empty())
+		tightenBounds();
+	return marker;
+}
+
+void SudokuDLXSolver::tightenBounds()
+{
+	// Bounds propagation: the larger cell of an inequality keeps only values above the smallest
+	// live value of the smaller one, which keeps only values below the largest of the larger
+	// one. Every row hidden can move other bounds, so repeat until nothing changes.
+	const DLXTopology& topo = *topology;
+	const int digits = topo.gridSize;
+	auto valueRange = [&](int cell, int& lowest, int& highest)
+	{
+		if (placedRow[cell] >= 0)
+		{
+			lowest = highest = placedRow[cell] - cell * digits + 1;
+			return;
+		}
+		lowest = digits + 1;
+		highest = 0;
+		for (int value = 1; value <= digits; ++value)
+			if (isRowAvailable(cell * digits + value - 1))
+			{
+				lowest = std::min(lowest, value);
+				highest = value;
+			}
+	};
+
+	for (bool changed = true; changed; )
+	{
+		changed = false;
+		for (size_t i = 0; i < topo.inequalityCells.size(); i += 2)
+		{
+			const int smaller = topo.inequalityCells[i];
+			const int larger = topo.inequalityCells[i + 1];
+			int smallerLow, smallerHigh, largerLow, largerHigh;
+			valueRange(smaller, smallerLow, smallerHigh);
+			valueRange(larger, largerLow, largerHigh);
+
+			// An empty cell fails on its own column, its neighbours need no pruning
+			if (smallerLow > smallerHigh || largerLow > largerHigh)
+				continue;
+
+			for (int value = largerLow; value <= std::min(smallerLow, digits); ++value)
+				if (isRowAvailable(larger * digits + value - 1))
+				{
+					hideRow(larger * digits + value - 1);
+					changed = true;
+				}
+			for (int value = std::max(largerHigh, 1); value <= smallerHigh; ++value)
+				if (isRowAvailable(smaller * digits + value - 1))
+				{
+					hideRow(smaller * digits + value - 1);
+					changed = true;
+				}
+		}
+	}
+}
+
+void SudokuDLXSolver::unhideConflicts(int marker)
+{
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const DLXTopology& topo = *topology;
+
+	while (static_cast<int>(hiddenRows.size()) > marker)
+	{
+		const int other = hiddenRows.back();
+		hiddenRows.pop_back();
+		rowHidden[other] = 0;
+		for (int node = topo.rowFirstNode[other + 1] - 1; node >= topo.rowFirstNode[other]; --node)
+			relinkNode(link, column, topo.nodeColumn.data(), node);
+	}
+}
+
+void SudokuDLXSolver::applyInitialConstraints(const std::vector<std::vector<int>>& puzzle,
+											  const std::vector<std::vector<std::uint64_t>>* candidates)
+{
+	const DLXTopology& topo = *topology;
+
+	// Pencil marks: drop the rows of every digit excluded from an empty cell
+	std::fill(rowExcluded.begin(), rowExcluded.end(), 0);
+	if (candidates != nullptr)
+	{
+		for (int i = 0; i < height; ++i)
+		{
+			for (int j = 0; j < width; ++j)
+			{
+				if (puzzle[i][j] > 0 || !topo.isCell(i, j))
+					continue;
+
+				const std::uint64_t allowed = (*candidates)[i][j];
+				for (int value = 1; value <= gridSize; ++value)
+					if (((allowed >> (value - 1)) & 1) == 0)
+						rowExcluded[topo.rowIndex(value, i, j)] = 1;
+			}
+		}
+	}
+
+	// Parity and inequality bounds apply to givens too: a given outside them is skipped like a
+	// clashing one
+	for (int row : topo.prunedRows)
+		rowExcluded[row] = 1;
+
+	// Pass 1: flag the columns of every given. A given that clashes with an earlier one is
+	// skipped, exactly as if the earlier one had been covered first.
+	std::fill(columnCovered.begin(), columnCovered.end(), 0);
+	for (int i = 0; i < height; ++i)
+	{
+		for (int j = 0; j < width; ++j)
+		{
+			const int value = puzzle[i][j];
+			if (value > 0 && value <= gridSize && topo.isCell(i, j))
+			{
+				const int row = topo.rowIndex(value, i, j);
+				if (isRowAvailable(row))
+				{
+					markRow(row, true);
+					fixedClues[clueCount++] = topo.rowFirstNode[row];
+
+					// Rows excluded by a given are dropped like pencil marks
+					if (!topo.conflictRows.empty())
+						for (int c = topo.conflictStart[row]; c < topo.conflictStart[row + 1]; ++c)
+							rowExcluded[topo.conflictRows[c]] = 1;
+				}
+			}
+		}
+	}
+
+	// Pass 2: link the uncovered columns and every row that avoids all covered columns once,
+	// instead of unlinking the eliminated rows one node at a time
+	const int rootHeader = 0;
+	int last = rootHeader;
+	columns[rootHeader].size = -1;
+	for (int col = 1; col <= topo.columnCount; ++col)
+	{
+		links[col].up = col;
+		links[col].down = col;
+		columns[col].size = 0;
+
+		// Secondary columns stay out of the header list, so the search never has to cover
+		// them; linked to themselves, covering one only unlinks its rows
+		if (col > topo.primaryColumnCount)
+		{
+			columns[col].left = col;
+			columns[col].right = col;
+			continue;
+		}
+		if (columnCovered[col])
+			continue;
+
+		columns[col].left = last;
+		columns[last].right = col;
+		last = col;
+	}
+	columns[last].right = rootHeader;
+	columns[rootHeader].left = last;
+
+	for (int row = 0; row < topo.rowCount; ++row)
+	{
+		if (!isRowAvailable(row))
+			continue;
+
+		for (int node = topo.rowFirstNode[row]; node < topo.rowFirstNode[row + 1]; ++node)
+		{
+			const int col = topo.nodeColumn[node];
+			links[node].up = links[col].up;
+			links[node].down = col;
+			links[links[col].up].down = node;
+			links[col].up = node;
+			columns[col].size++;
+		}
+	}
+}
+
+void SudokuDLXSolver::recordSolution(int depth, int searchLimit,
+									 std::vector<std::vector<std::vector<int>>>& solutions)
 {
+	if (rowVisitor != nullptr)
+	{
+		visitedRows.clear();
+		for (int i = 0; i < clueCount; ++i)
+			visitedRows.push_back(topology->nodeRow[fixedClues[i]]);
+		for (int i = 0; i < depth; ++i)
+			visitedRows.push_back(topology->nodeRow[solution[i]]);
+
+		// A visitor that has seen enough stops the search like a reached limit
+		visitedSolutions++;
+		if (!(*rowVisitor)(visitedRows))
+			solutionCount = searchLimit;
+	}
+	else
+	{
+		std::vector<std::vector<int>> sudokuGrid(height, std::vector<int>(width, 0));
+		mapSolutionToGrid(sudokuGrid, depth);
+		solutions.push_back(sudokuGrid);
+		solutionCount++;
+	}
+	DLX_PROBE3(solution__found, depth, solutionCount, searchNodes);
 }
 
-SudokuDLXSolver::SudokuDLXSolver(int size)
-	: gridSize(size)
-	, blockSize(static_cast<int>(std::sqrt(size)))
-	, cellCount(size * size)
-	, exactCoverRows(size * cellCount)
-	, exactCoverCols(4 * cellCount)
-	, rootHeader(nullptr)
-	, solution(cellCount, nullptr)
-	, fixedClues(cellCount, nullptr)
-	, solutionCount(0)
+void SudokuDLXSolver::mapSolutionToGrid(std::vector<std::vector<int>>& sudoku, int depth) const
+{
+	for (int i = 0; i < depth; ++i)
+	{
+		const DLXRowData& data = topology->rowData[topology->nodeRow[solution[i]]];
+		sudoku[data.row][data.col] = data.value;
+	}
+	for (int i = 0; i < clueCount; ++i)
+	{
+		const DLXRowData& data = topology->rowData[topology->nodeRow[fixedClues[i]]];
+		sudoku[data.row][data.col] = data.value;
+	}
+}
+
+template <typename T>
+static void validateDimensions(const std::vector<std::vector<T>>& grid, int height, int width, const char* what)
+{
+	if (grid.size() != static_cast<size_t>(height) ||
+		(grid.size() > 0 && grid[0].size() != static_cast<size_t>(width)))
+		throw std::invalid_argument(std::string("Expected ") + what + " dimensions " +
+			std::to_string(height) + "x" + std::to_string(width) +
+			", but got " + std::to_string(grid.size()) + "x" +
+			std::to_string(grid.size() > 0 ? grid[0].size() : 0));
+}
+
+void SudokuDLXSolver::validatePuzzle(const std::vector<std::vector<int>>& puzzle) const
+{
+	validateDimensions(puzzle, height, width, "puzzle");
+}
+
+void SudokuDLXSolver::load(const std::vector<std::vector<int>>& puzzle)
+{
+	validatePuzzle(puzzle);
+	loadState(puzzle, nullptr);
+}
+
+void SudokuDLXSolver::load(const std::vector<std::vector<int>>& puzzle,
+						   const std::vector<std::vector<std::uint64_t>>& candidates)
+{
+	if (gridSize > 64)
+		throw std::invalid_argument("Candidate masks hold at most 64 digits, but the grid size is " + std::to_string(gridSize));
+
+	validatePuzzle(puzzle);
+	validateDimensions(candidates, height, width, "candidate");
+	loadState(puzzle, &candidates);
+}
+
+void SudokuDLXSolver::loadState(const std::vector<std::vector<int>>& puzzle,
+								const std::vector<std::vector<std::uint64_t>>* candidates)
+{
+	// Every live link is rebuilt by applyInitialConstraints(), so only the storage is needed here
+	links.resize(topology->nodeColumn.size());
+	columns.resize(topology->columnCount + 1);
+	columnCovered.resize(topology->columnCount + 1);
+	rowExcluded.resize(topology->rowCount);
+	rowHidden.assign(topology->rowCount, 0);
+	placedRow.assign(cellCount, -1);
+	nodeColor = topology->nodeColor;
+	if (!topology->columnUpper.empty())
+		columnUses.assign(topology->columnCount + 1, 0);
+	hiddenRows.clear();
+	clueHidden.clear();
+	if (tracksRows())
+	{
+		hiddenRows.reserve(topology->rowCount);
+		clueHidden.resize(topology->maxDepth);
+	}
+	clueCount = 0;
+	std::fill(solution.begin(), solution.end(), -1);
+	std::fill(fixedClues.begin(), fixedClues.end(), -1);
+
+	applyInitialConstraints(puzzle, candidates);
+	givenCount = clueCount;
+
+	// The givens narrow the inequality bounds below the static ones; what this hides stays
+	// below every trail marker, so only the next load() restores it
+	if (!topology->inequalityCells.empty())
+		tightenBounds();
+	DLX_PROBE2(clues__applied, gridSize, givenCount);
+	loaded = true;
+	neverLoaded = false;
+}
+
+// Back to the state of a new solver, but with the link arrays kept allocated by an empty load
+void SudokuDLXSolver::resetForReuse()
 {
-	if (blockSize * blockSize != size)
-		throw std::invalid_argument("Grid size must be a perfect square (e.g., 4, 9, 16, 25), but got: " + std::to_string(size));
+	setPropagator(nullptr);
+	setProgressCallback(nullptr);
+	setSlowLog(SlowLogConfig());
+	setHybridThreshold(0);
+	loadState(std::vector<std::vector<int>>(height, std::vector<int>(width, 0)), nullptr);
+	solutionCount = 0;
+	searchNodes = 0;
+	solutionBytes = 0;
+	lastSolveMemory = MemoryBreakdown();
 }
 
-void SudokuDLXSolver::coverColumn(DLXNode* col)
+bool SudokuDLXSolver::place(int row, int col, int value)
 {
-	col->left->right = col->right;
-	col->right->left = col->left;
-	for (DLXNode* node = col->down; node != col; node = node->down)
+	if (!loaded)
+		throw std::logic_error("place() needs a loaded puzzle, call load() first");
+	if (row < 0 || row >= height || col < 0 || col >= width || value < 1 || value > gridSize ||
+		!topology->isCell(row, col))
+		throw std::out_of_range("Placement (" + std::to_string(row) + ", " + std::to_string(col) +
+			") = " + std::to_string(value) + " is outside the " +
+			std::to_string(height) + "x" + std::to_string(width) + " grid");
+
+	// The row is only available while it is still compatible with everything placed so far
+	const int exactCoverRow = topology->rowIndex(value, row, col);
+	if (!isRowAvailable(exactCoverRow))
+		return false;
+
+	const int node = topology->rowFirstNode[exactCoverRow];
+	coverRow(node);
+	markRow(exactCoverRow, true);
+	if (!clueHidden.empty())
+		clueHidden[clueCount] = static_cast<int>(hiddenRows.size());
+	if (tracksRows())
 	{
-		for (DLXNode* temp = node->right; temp != node; temp = temp->right)
+		hideConflicts(exactCoverRow);
+		bool consistent;
+		try
+		{
+			consistent = propagate(exactCoverRow);
+		}
+		catch (...)
+		{
+			// The row stays covered without a trail entry to restore it from
+			loaded = false;
+			throw;
+		}
+		if (!consistent)
 		{
-			temp->down->up = temp->up;
-			temp->up->down = temp->down;
-			temp->column->columnSize--;
+			unhideConflicts(clueHidden[clueCount]);
+			markRow(exactCoverRow, false);
+			uncoverRow(node);
+			return false;
 		}
 	}
+	fixedClues[clueCount++] = node;
+	return true;
+}
+
+void SudokuDLXSolver::restoreState(int marker)
+{
+	if (!loaded)
+		throw std::logic_error("restoreState() needs a loaded puzzle, call load() first");
+	if (marker < givenCount || marker > clueCount)
+		throw std::invalid_argument("State marker " + std::to_string(marker) +
+			" is not on the current trail (givens " + std::to_string(givenCount) +
+			", depth " + std::to_string(clueCount) + ")");
+
+	while (clueCount > marker)
+	{
+		const int node = fixedClues[--clueCount];
+		fixedClues[clueCount] = -1;
+		if (!clueHidden.empty())
+			unhideConflicts(clueHidden[clueCount]);
+		uncoverRow(node);
+		markRow(topology->nodeRow[node], false);
+	}
 }
 
-void SudokuDLXSolver::uncoverColumn(DLXNode* col)
+// Takes the row of `node` for bounded (DLX3) problems: the row leaves every list, then each of
+// its primary columns counts one more use and is covered once at its maximum, while its
+// secondary columns are covered or purified as in coverSiblings()
+void SudokuDLXSolver::chooseRow(int node)
 {
-	for (DLXNode* node = col->up; node != col; node = node->up)
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const DLXTopology& topo = *topology;
+	const int row = topo.nodeRow[node];
+
+	for (int temp = topo.rowFirstNode[row]; temp < topo.rowFirstNode[row + 1]; ++temp)
+		unlinkNode(link, column, topo.nodeColumn.data(), temp);
+
+	for (int temp = topo.rowFirstNode[row]; temp < topo.rowFirstNode[row + 1]; ++temp)
 	{
-		for (DLXNode* temp = node->left; temp != node; temp = temp->left)
+		const int col = topo.nodeColumn[temp];
+		if (col <= topo.primaryColumnCount)
 		{
-			temp->column->columnSize++;
-			temp->down->up = temp;
-			temp->up->down = temp;
+			if (++columnUses[col] == topo.columnUpper[col])
+				coverColumn(col);
 		}
+		else if (nodeColor.empty() || nodeColor[temp] == 0)
+			coverColumn(col);
+		else if (nodeColor[temp] > 0)
+			purify(temp);
 	}
-	col->left->right = col;
-	col->right->left = col;
 }
 
-void SudokuDLXSolver::searchDLX(int k, int searchLimit, std::vector<std::vector<std::vector<int>>>& solutions)
+void SudokuDLXSolver::unchooseRow(int node)
+{
+	DLXLink* const link = links.data();
+	DLXColumn* const column = columns.data();
+	const DLXTopology& topo = *topology;
+	const int row = topo.nodeRow[node];
+
+	for (int temp = topo.rowFirstNode[row + 1] - 1; temp >= topo.rowFirstNode[row]; --temp)
+	{
+		const int col = topo.nodeColumn[temp];
+		if (col <= topo.primaryColumnCount)
+		{
+			if (columnUses[col]-- == topo.columnUpper[col])
+				uncoverColumn(col);
+		}
+		else if (nodeColor.empty() || nodeColor[temp] == 0)
+			uncoverColumn(col);
+		else if (nodeColor[temp] > 0)
+			unpurify(temp);
+	}
+
+	for (int temp = topo.rowFirstNode[row + 1] - 1; temp >= topo.rowFirstNode[row]; --temp)
+		relinkNode(link, column, topo.nodeColumn.data(), temp);
+}
+
+// Search for topologies with multiplicities, after Knuth's Algorithm M. A column still `need`
+// uses short of its minimum branches on each of its rows in turn as the first of the rows it
+// gets from here on, and a row that has been tried is hidden for the rest of the level, so
+// each set of rows is found once. Once the minimum is met, one more branch takes no further
+// rows for the column. `level` counts branchings, `k` the rows chosen so far.
+void SudokuDLXSolver::searchBounded(int level, int k, int searchLimit,
+									std::vector<std::vector<std::vector<int>>>& solutions)
 {
 	if (solutionCount >= searchLimit)
 		return;
 
-	if (rootHeader->right == rootHeader)
+	searchNodes++;
+	DLX_SEARCH_PROBE(k, searchNodes);
+	if (progressInterval != 0 && --progressCountdown == 0)
+		reportProgress(level);
+
+	const DLXTopology& topo = *topology;
+	const int rootHeader = 0;
+	if (columns[rootHeader].right == rootHeader)
 	{
-		std::vector<std::vector<int>> sudokuGrid(gridSize, std::vector<int>(gridSize, 0));
-		mapSolutionToGrid(sudokuGrid);
-		solutions.push_back(sudokuGrid);
-		solutionCount++;
+		recordSolution(k, searchLimit, solutions);
 		return;
 	}
 
-	// Select column with minimum size (heuristic)
-	DLXNode* col = rootHeader->right;
-	for (DLXNode* temp = col->right; temp != rootHeader; temp = temp->right)
-		if (temp->columnSize < col->columnSize)
+	// Minimum remaining values with multiplicities: only the first size - need + 1 rows can
+	// start the column's remaining uses, and a column without need also has the empty branch
+	int col = rootHeader;
+	int degree = INT_MAX;
+	for (int temp = columns[rootHeader].right; temp != rootHeader; temp = columns[temp].right)
+	{
+		const int tempDegree = columns[temp].size + 1 - std::max(0, topo.columnLower[temp] - columnUses[temp]);
+		if (tempDegree < degree)
+		{
 			col = temp;
+			degree = tempDegree;
+		}
+	}
+	if (degree <= 0)
+		return;
 
-	coverColumn(col);
+	const int need = std::max(0, topo.columnLower[col] - columnUses[col]);
+	const int hidden = static_cast<int>(hiddenRows.size());
+	branchIndex[level] = 0;
+	branchCount[level] = degree;
 
-	for (DLXNode* temp = col->down; temp != col; temp = temp->down)
+	bool limitReached = false;
+	while (links[col].down != col && columns[col].size >= need)
 	{
-		solution[k] = temp;
-		for (DLXNode* node = temp->right; node != temp; node = node->right)
-			coverColumn(node->column);
+		const int node = links[col].down;
+		solution[k] = node;
+		chooseRow(node);
+		searchBounded(level + 1, k + 1, searchLimit, solutions);
 
-		searchDLX(k + 1, searchLimit, solutions);
+		limitReached = solutionCount >= searchLimit;
+		if (limitReached && !unwindOnAbort)
+			return;
 
-		temp = solution[k];
-		solution[k] = nullptr;
-		col = temp->column;
-		for (DLXNode* node = temp->left; node != temp; node = node->left)
-			uncoverColumn(node->column);
+		solution[k] = -1;
+		unchooseRow(node);
+		if (limitReached)
+			break;
+
+		hideRow(topo.nodeRow[node]);
+		branchIndex[level]++;
 	}
 
-	uncoverColumn(col);
+	if (need == 0 && !limitReached)
+	{
+		coverColumn(col);
+		searchBounded(level + 1, k, searchLimit, solutions);
+		if (solutionCount >= searchLimit && !unwindOnAbort)
+			return;
+		uncoverColumn(col);
+	}
+
+	unhideConflicts(hidden);
 }
 
-void SudokuDLXSolver::buildExactCoverMatrix(std::vector<std::vector<bool>>& exactCoverMatrix)
+std::vector<std::vector<std::vector<int>>> SudokuDLXSolver::runSearch(int searchLimit, bool unwind)
 {
-	// Constraint 1: Each cell can only be filled with one number
-	int j = 0, counter = 0;
-	for (int i = 0; i < exactCoverRows; ++i)
+	if (rowVisitor == nullptr && gridSize == 0)
+		throw std::logic_error("This topology has no grid to return solutions in, use enumerateRows()");
+
+	std::vector<std::vector<std::vector<int>>> solutions;
+	solutions.reserve(searchLimit);
+	solutionCount = 0;
+	searchNodes = 0;
+	progressCountdown = progressInterval;
+	unwindOnAbort = unwind;
+
+	// The propagator also sees the starting state; what it removes is restored afterwards
+	const int hidden = static_cast<int>(hiddenRows.size());
+	try
 	{
-		exactCoverMatrix[i][j] = true;
-		counter++;
-		if (counter >= gridSize)
-		{
-			j++;
-			counter = 0;
-		}
+		if (!topology->columnUpper.empty())
+			searchBounded(0, 0, searchLimit, solutions);
+		else if (propagate(-1))
+			searchDLX(0, searchLimit, solutions);
 	}
-
-	// Constraint 2: Each number appears exactly once in each row
-	int x = 0;
-	counter = 1;
-	for (j = cellCount; j < 2 * cellCount; ++j)
+	catch (...)
 	{
-		for (int i = x; i < counter * cellCount; i += gridSize)
-			exactCoverMatrix[i][j] = true;
-
-		if ((j + 1) % gridSize == 0)
-		{
-			x = counter * cellCount;
-			counter++;
-		}
-		else
-			x++;
+		// A callback threw from inside the search, so the links are still covered
+		unwindOnAbort = true;
+		loaded = false;
+		throw;
 	}
+	if (unwind || solutionCount < searchLimit)
+		unhideConflicts(hidden);
+	unwindOnAbort = true;
+
+	// Without unwinding an aborted search leaves the links half covered
+	if (!unwind && solutionCount >= searchLimit)
+		loaded = false;
 
-	// Constraint 3: Each number appears exactly once in each column
-	j = 2 * cellCount;
-	for (int i = 0; i < exactCoverRows; ++i)
+	// Buffers only grow during a solve, so the state at the end is the solve's peak
+	solutionBytes = vectorBytes(solutions);
+	for (const std::vector<std::vector<int>>& grid : solutions)
 	{
-		exactCoverMatrix[i][j] = true;
-		j++;
-		if (j >= 3 * cellCount)
-			j = 2 * cellCount;
+		solutionBytes += vectorBytes(grid);
+		for (const std::vector<int>& row : grid)
+			solutionBytes += vectorBytes(row);
 	}
+	recordSolveMemory(0);
 
-	// Constraint 4: Each number appears exactly once in each block
-	x = 0;
-	for (j = 3 * cellCount; j < exactCoverCols; ++j)
-	{
-		for (int l = 0; l < blockSize; ++l)
-			for (int k = 0; k < blockSize; ++k)
-				exactCoverMatrix[x + l * gridSize + k * cellCount][j] = true;
+	// An exhausted search has explored the whole tree
+	if (progressCallback && solutionCount < searchLimit)
+		progressCallback(1.0);
+
+	return solutions;
+}
 
-		int temp = j + 1 - 3 * cellCount;
+std::vector<std::vector<std::vector<int>>> SudokuDLXSolver::search(int searchLimit)
+{
+	if (!loaded)
+		throw std::logic_error("search() needs a loaded puzzle, call load() first");
 
-		if (temp % (blockSize * gridSize) == 0)
-			x += (blockSize - 1) * cellCount + (blockSize - 1) * gridSize + 1;
-		else if (temp % gridSize == 0)
-			x += gridSize * (blockSize - 1) + 1;
-		else
-			x++;
+	return runSearch(searchLimit, true);
+}
+
+unsigned long long SudokuDLXSolver::enumerateRows(const std::function<bool(const std::vector<int>&)>& visit)
+{
+	if (!loaded && !neverLoaded)
+		throw std::logic_error("enumerateRows() needs a loaded puzzle, call load() first");
+	if (!loaded)
+		loadState(std::vector<std::vector<int>>(height, std::vector<int>(width, 0)), nullptr);
+
+	rowVisitor = &visit;
+	visitedSolutions = 0;
+	visitedRows.reserve(topology->maxDepth);
+	try
+	{
+		runSearch(1, true);
+	}
+	catch (...)
+	{
+		// runSearch() has already invalidated the links
+		rowVisitor = nullptr;
+		throw;
 	}
+	rowVisitor = nullptr;
+
+	solutionCount = static_cast<int>(std::min<unsigned long long>(visitedSolutions, INT_MAX));
+	return visitedSolutions;
 }
 
-void SudokuDLXSolver::buildDLXLinkedList(const std::vector<std::vector<bool>>& exactCoverMatrix)
+// Memo of countSolutions(): covered-column bitset -> count and ZDD node of that residual problem.
+// A direct-mapped table of flat records, like a transposition table: it doubles while under the
+// byte budget and then overwrites, so a lookup touches one record and memory stays bounded.
+struct SudokuDLXSolver::MemoTable
 {
-	allNodes.reserve(1 + exactCoverCols + 4 * exactCoverRows);
+	static const size_t kHeader = 3;               // record: hash, count, ZDD node, then the key words
+	static const std::uint64_t kEmpty = ~0ULL;     // ZDD node word of an unused record
 
-	allNodes.push_back(std::make_unique<DLXNode>());
-	DLXNode* header = allNodes.back().get();
+	std::vector<std::uint64_t> key;  // one bit per column, set while the column is covered
+	std::uint64_t hash;              // Zobrist hash of key: XOR of columnHash over the set bits
+	std::vector<std::uint64_t> columnHash;
+	std::vector<std::uint64_t> records;
+	size_t capacity;                 // records, a power of two
+	size_t maxCapacity;
+	size_t used;
+	SolutionZDD* zdd;                // nullptr when only counting
 
-	header->left = header;
-	header->right = header;
-	header->down = header;
-	header->up = header;
-	header->columnSize = -1;
-	header->column = header;
-	DLXNode* temp = header;
+	size_t stride() const { return kHeader + key.size(); }
 
-	// Create all Column Nodes
-	for (int i = 0; i < exactCoverCols; ++i)
+	void toggle(int col)
 	{
-		allNodes.push_back(std::make_unique<DLXNode>());
-		DLXNode* newNode = allNodes.back().get();
+		key[col >> 6] ^= 1ULL << (col & 63);
+		hash ^= columnHash[col];
+	}
 
-		newNode->columnSize = 0;
-		newNode->up = newNode;
-		newNode->down = newNode;
-		newNode->column = newNode;
-		newNode->right = header;
-		newNode->left = temp;
-		temp->right = newNode;
-		temp = newNode;
+	void toggleRow(const DLXTopology& topo, int node)
+	{
+		const int row = topo.nodeRow[node];
+		for (int temp = topo.rowFirstNode[row]; temp < topo.rowFirstNode[row + 1]; ++temp)
+			toggle(topo.nodeColumn[temp]);
 	}
 
-	std::vector<int> id = { 0, 1, 1 };
+	// Where the current key is stored, if it is
+	const std::uint64_t* slot() const { return &records[(hash & (capacity - 1)) * stride()]; }
 
-	// Add a Node for each true value in the matrix
-	for (int i = 0; i < exactCoverRows; ++i)
+	// Record of the current key, or nullptr
+	const std::uint64_t* find() const
 	{
-		DLXNode* top = header->right;
-		DLXNode* prev = nullptr;
+		const std::uint64_t* record = slot();
+		if (record[2] != kEmpty && record[0] == hash && std::equal(key.begin(), key.end(), record + kHeader))
+			return record;
+		return nullptr;
+	}
 
-		if (i != 0 && i % cellCount == 0)
-		{
-			id[0] -= gridSize - 1;
-			id[1]++;
-			id[2] -= gridSize - 1;
-		}
-		else if (i != 0 && i % gridSize == 0)
-		{
-			id[0] -= gridSize - 1;
-			id[2]++;
-		}
-		else
+	void insert(unsigned long long count, int zddNode)
+	{
+		if (used * 2 >= capacity && capacity < maxCapacity)
 		{
-			id[0]++;
+			std::vector<std::uint64_t> old(capacity * 2 * stride(), kEmpty);
+			old.swap(records);
+			capacity *= 2;
+			used = 0;
+			for (size_t i = 0; i < old.size(); i += stride())
+				if (old[i + 2] != kEmpty)
+					store(&old[i]);
 		}
 
-		for (int j = 0; j < exactCoverCols; j++, top = top->right)
-		{
-			if (exactCoverMatrix[i][j])
-			{
-				allNodes.push_back(std::make_unique<DLXNode>());
-				DLXNode* newNode = allNodes.back().get();
+		std::uint64_t* record = &records[(hash & (capacity - 1)) * stride()];
+		used += record[2] == kEmpty;
+		record[0] = hash;
+		record[1] = count;
+		record[2] = static_cast<std::uint64_t>(zddNode);
+		std::copy(key.begin(), key.end(), record + kHeader);
+	}
 
-				newNode->rowData[0] = id[0];
-				newNode->rowData[1] = id[1];
-				newNode->rowData[2] = id[2];
+	void store(const std::uint64_t* from)
+	{
+		std::uint64_t* record = &records[(from[0] & (capacity - 1)) * stride()];
+		used += record[2] == kEmpty;
+		std::copy(from, from + stride(), record);
+	}
+};
 
-				if (prev == nullptr)
-				{
-					prev = newNode;
-					prev->right = newNode;
-				}
-				newNode->left = prev;
-				newNode->right = prev->right;
-				newNode->right->left = newNode;
-				prev->right = newNode;
-				newNode->column = top;
-				newNode->down = top;
-				newNode->up = top->up;
-				top->up->down = newNode;
-				top->columnSize++;
-				top->up = newNode;
-				if (top->down == top)
-					top->down = newNode;
-				prev = newNode;
-			}
+const size_t SudokuDLXSolver::MemoTable::kHeader;
+const std::uint64_t SudokuDLXSolver::MemoTable::kEmpty;
+
+unsigned long long SudokuDLXSolver::countSolutions(SolutionZDD* zdd, size_t memoBytes)
+{
+	const DLXTopology& topo = *topology;
+	if (!topo.conflictRows.empty() || propagator || !topo.nodeColor.empty() || !topo.columnUpper.empty())
+		throw std::logic_error("countSolutions() cannot memoize with exclusion rules, inequalities, propagators, "
+			"colors or multiplicities");
+	if (!loaded && !neverLoaded)
+		throw std::logic_error("countSolutions() needs a loaded puzzle, call load() first");
+	if (!loaded)
+		loadState(std::vector<std::vector<int>>(height, std::vector<int>(width, 0)), nullptr);
+
+	// Outside a search columnCovered holds exactly the columns of the givens and placements
+	MemoTable memo;
+	std::mt19937_64 rng(topo.columnCount);
+	memo.key.assign(topo.columnCount / 64 + 1, 0);
+	memo.hash = 0;
+	memo.columnHash.resize(topo.columnCount + 1);
+	for (int col = 1; col <= topo.columnCount; ++col)
+	{
+		memo.columnHash[col] = rng();
+		if (columnCovered[col])
+			memo.toggle(col);
+	}
+
+	const size_t recordBytes = memo.stride() * sizeof(std::uint64_t);
+	memo.capacity = 1024;
+	memo.maxCapacity = memo.capacity;
+	while (memo.maxCapacity * 2 * recordBytes <= memoBytes)
+		memo.maxCapacity *= 2;
+	memo.records.assign(memo.capacity * memo.stride(), MemoTable::kEmpty);
+	memo.used = 0;
+	memo.zdd = zdd;
+	if (zdd != nullptr)
+		zdd->nodes.assign({ { -1, 0, 0 }, { -1, 1, 1 } });
+
+	searchNodes = 0;
+	int root = 0;
+	const unsigned long long count = countMemoized(memo, root);
+	solutionCount = static_cast<int>(std::min<unsigned long long>(count, INT_MAX));
+
+	// Givens and placements belong to every solution, so they sit on a hi chain above the root
+	if (zdd != nullptr)
+	{
+		for (int i = clueCount - 1; i >= 0 && count > 0; --i)
+		{
+			zdd->nodes.push_back({ topo.nodeRow[fixedClues[i]], 0, root });
+			root = static_cast<int>(zdd->nodes.size()) - 1;
 		}
+		zdd->root = root;
 	}
 
-	rootHeader = header;
+	// The table only grows, so its size at the end is its peak
+	solutionBytes = zdd != nullptr ? vectorBytes(zdd->nodes) : 0;
+	recordSolveMemory(vectorBytes(memo.records) + vectorBytes(memo.key) + vectorBytes(memo.columnHash));
+	return count;
 }
 
-DLXNode* SudokuDLXSolver::findNodeForClue(int value, int row, int col)
+unsigned long long SudokuDLXSolver::countMemoized(MemoTable& memo, int& zddNode)
 {
-	for (DLXNode* colHeader = rootHeader->right; colHeader != rootHeader; colHeader = colHeader->right)
+	searchNodes++;
+	const int rootHeader = 0;
+	if (columns[rootHeader].right == rootHeader)
+	{
+		zddNode = 1;
+		return 1;
+	}
+
+	const std::uint64_t* const found = memo.find();
+	if (found != nullptr)
+	{
+		zddNode = static_cast<int>(found[2]);
+		return found[1];
+	}
+
+	int col = columns[rootHeader].right;
+	for (int temp = columns[col].right; temp != rootHeader; temp = columns[temp].right)
+		if (columns[temp].size < columns[col].size)
+			col = temp;
+
+	// Rows are taken bottom-up so that each ZDD node can point its lo edge at the one built
+	// for the row below it
+	unsigned long long count = 0;
+	zddNode = 0;
+	coverColumn(col);
+	for (int node = links[col].up; node != col; node = links[node].up)
 	{
-		for (DLXNode* node = colHeader->down; node != colHeader; node = node->down)
+		// The child's record is fetched while its columns are being covered
+		memo.toggleRow(*topology, node);
+		DLX_PREFETCH_READ(memo.slot());
+		coverSiblings(node);
+
+		int child = 0;
+		const unsigned long long childCount = countMemoized(memo, child);
+		count = childCount > ULLONG_MAX - count ? ULLONG_MAX : count + childCount;
+		if (childCount > 0 && memo.zdd != nullptr)
 		{
-			if (node->rowData[0] == value &&
-				(node->rowData[1] - 1) == row &&
-				(node->rowData[2] - 1) == col)
-			{
-				return node;
-			}
+			memo.zdd->nodes.push_back({ topology->nodeRow[node], zddNode, child });
+			zddNode = static_cast<int>(memo.zdd->nodes.size()) - 1;
 		}
+
+		memo.toggleRow(*topology, node);
+		uncoverSiblings(node);
 	}
-	return nullptr;
+	uncoverColumn(col);
+
+	memo.insert(count, zddNode);
+	return count;
 }
 
-void SudokuDLXSolver::applyInitialConstraints(const std::vector<std::vector<int>>& puzzle)
+double SudokuDLXSolver::estimateSearchCost(int samples, unsigned seed)
 {
-	int index = 0;
-	for (int i = 0; i < gridSize; ++i)
+	if (!loaded)
+		throw std::logic_error("estimateSearchCost() needs a loaded puzzle, call load() first");
+	if (samples < 1)
+		throw std::invalid_argument("Sample count must be positive, but got: " + std::to_string(samples));
+	if (!topology->columnUpper.empty())
+		throw std::logic_error("estimateSearchCost() does not support column multiplicities");
+
+	const int rootHeader = 0;
+	std::mt19937 rng(seed);
+	std::vector<int> path;
+	std::vector<int> pathHidden; // hideConflicts() markers, with exclusion rules only
+	path.reserve(topology->maxDepth);
+	const bool trackRows = tracksRows();
+
+	double total = 0.0;
+	for (int s = 0; s < samples; ++s)
 	{
-		for (int j = 0; j < gridSize; ++j)
+		// Knuth's estimator: follow one random root-to-leaf path with the same column choice as
+		// searchDLX(); the node count is 1 + d1 + d1*d2 + ... over the branching factors d
+		double estimate = 1.0;
+		double levelWidth = 1.0;
+		while (columns[rootHeader].right != rootHeader)
 		{
-			if (puzzle[i][j] > 0)
-			{
-				DLXNode* temp = findNodeForClue(puzzle[i][j], i, j);
+			int col = columns[rootHeader].right;
+			for (int temp = columns[col].right; temp != rootHeader; temp = columns[temp].right)
+				if (columns[temp].size < columns[col].size)
+					col = temp;
 
-				if (temp != nullptr)
-				{
-					DLXNode* col = temp->column;
-					coverColumn(col);
-					fixedClues[index] = temp;
-					index++;
+			const int size = columns[col].size;
+			if (size == 0)
+				break;
 
-					for (DLXNode* node = temp->right; node != temp; node = node->right)
-						coverColumn(node->column);
+			levelWidth *= size;
+			estimate += levelWidth;
+
+			int node = links[col].down;
+			for (int skip = std::uniform_int_distribution<int>(0, size - 1)(rng); skip > 0; --skip)
+				node = links[node].down;
+
+			coverColumn(col);
+			coverSiblings(node);
+			path.push_back(node);
+			if (trackRows)
+			{
+				markRow(topology->nodeRow[node], true);
+				pathHidden.push_back(hideConflicts(topology->nodeRow[node]));
+				bool consistent;
+				try
+				{
+					consistent = propagate(topology->nodeRow[node]);
 				}
+				catch (...)
+				{
+					// The path is still covered
+					loaded = false;
+					throw;
+				}
+				if (!consistent)
+					break;
+			}
+		}
+
+		while (!path.empty())
+		{
+			const int node = path.back();
+			path.pop_back();
+			if (trackRows)
+			{
+				unhideConflicts(pathHidden.back());
+				pathHidden.pop_back();
+				markRow(topology->nodeRow[node], false);
 			}
+			uncoverSiblings(node);
+			uncoverColumn(topology->nodeColumn[node]);
 		}
+		total += estimate;
 	}
+	return total / samples;
+}
+
+double SudokuDLXSolver::estimateCost(const std::vector<std::vector<int>>& puzzle, int samples, unsigned seed)
+{
+	load(puzzle);
+	return estimateSearchCost(samples, seed);
+}
+
+MemoryBreakdown SudokuDLXSolver::measureMemory() const
+{
+	MemoryBreakdown bytes;
+	bytes.topology = topology->memoryBytes();
+	bytes.links = vectorBytes(links) + vectorBytes(columns) + vectorBytes(nodeColor);
+	bytes.search = sizeof(SudokuDLXSolver) + vectorBytes(solution) + vectorBytes(fixedClues) +
+		vectorBytes(columnCovered) + vectorBytes(rowExcluded) + vectorBytes(rowHidden) + vectorBytes(hiddenRows) +
+		vectorBytes(clueHidden) + vectorBytes(placedRow) + vectorBytes(visitedRows) + vectorBytes(branchIndex) + vectorBytes(branchCount) +
+		vectorBytes(columnUses) +
+		vectorBytes(residual.columnBit) + vectorBytes(residual.rowMask) + vectorBytes(residual.rowNode) +
+		vectorBytes(residual.columnStart) + vectorBytes(residual.columnRows);
+	bytes.solutions = solutionBytes;
+	return bytes;
+}
+
+// `scratchBytes` are search buffers already freed when the search returns, like the memo table
+void SudokuDLXSolver::recordSolveMemory(size_t scratchBytes)
+{
+	lastSolveMemory = measureMemory();
+	lastSolveMemory.search += scratchBytes;
+	peakMemory.topology = std::max(peakMemory.topology, lastSolveMemory.topology);
+	peakMemory.links = std::max(peakMemory.links, lastSolveMemory.links);
+	peakMemory.search = std::max(peakMemory.search, lastSolveMemory.search);
+	peakMemory.solutions = std::max(peakMemory.solutions, lastSolveMemory.solutions);
 }
 
-void SudokuDLXSolver::mapSolutionToGrid(std::vector<std::vector<int>>& sudoku)
+MemoryUsage SudokuDLXSolver::getMemoryUsage() const
 {
-	for (int i = 0; solution[i] != nullptr; ++i)
-		sudoku[solution[i]->rowData[1] - 1][solution[i]->rowData[2] - 1] = solution[i]->rowData[0];
-	for (int i = 0; fixedClues[i] != nullptr; ++i)
-		sudoku[fixedClues[i]->rowData[1] - 1][fixedClues[i]->rowData[2] - 1] = fixedClues[i]->rowData[0];
+	MemoryUsage usage;
+	usage.current = measureMemory();
+	usage.lastSolve = lastSolveMemory;
+
+	usage.peak = peakMemory;
+	usage.peak.topology = std::max(peakMemory.topology, topology->constructionBytes);
+	usage.peak.links = std::max(peakMemory.links, usage.current.links);
+	usage.peak.search = std::max(peakMemory.search, usage.current.search);
+	usage.peak.solutions = std::max(peakMemory.solutions, usage.current.solutions);
+	return usage;
+}
+
+SudokuDLXSolver SudokuDLXSolver::clone() const
+{
+	// Nodes are linked by index and the topology is immutable, so copying the link arrays
+	// gives an independent solver in exactly the same cover state
+	return SudokuDLXSolver(*this);
 }
 
 std::vector<std::vector<std::vector<int>>> SudokuDLXSolver::solve(const std::vector<std::vector<int>>& puzzle, 
 																   int searchLimit)
 {
-	// Validate puzzle dimensions
-	if (puzzle.size() != gridSize ||
-		(puzzle.size() > 0 && puzzle[0].size() != gridSize))
-		throw std::invalid_argument("Expected puzzle dimensions " +
-			std::to_string(gridSize) + "x" + std::to_string(gridSize) +
-			", but got " + std::to_string(puzzle.size()) + "x" +
-			std::to_string(puzzle.size() > 0 ? puzzle[0].size() : 0));
+	return solveAndLog(puzzle, nullptr, searchLimit);
+}
 
-	std::vector<std::vector<std::vector<int>>> solutions;
-	solutions.reserve(searchLimit);
-	solutionCount = 0;
-	allNodes.clear();
-	std::fill(solution.begin(), solution.end(), nullptr);
-	std::fill(fixedClues.begin(), fixedClues.end(), nullptr);
+std::vector<std::vector<std::vector<int>>> SudokuDLXSolver::solve(const std::vector<std::vector<int>>& puzzle,
+																   const std::vector<std::vector<std::uint64_t>>& candidates,
+																   int searchLimit)
+{
+	return solveAndLog(puzzle, &candidates, searchLimit);
+}
+
+std::vector<std::vector<std::vector<int>>> SudokuDLXSolver::solveAndLog(const std::vector<std::vector<int>>& puzzle,
+																		 const std::vector<std::vector<std::uint64_t>>* candidates,
+																		 int searchLimit)
+{
+	DLX_PROBE2(solve__start, gridSize, searchLimit);
+
+	// The clock is only read when a slow log is configured
+	const bool timed = !slowLog.path.empty();
+	std::chrono::steady_clock::time_point start;
+	if (timed)
+		start = std::chrono::steady_clock::now();
 
-	std::vector<std::vector<bool>> exactCoverMatrix(exactCoverRows,
-		std::vector<bool>(exactCoverCols, false));
+	// load() resets every link, so an aborted search does not need to unwind
+	if (candidates != nullptr)
+		load(puzzle, *candidates);
+	else
+		load(puzzle);
+	std::vector<std::vector<std::vector<int>>> solutions = runSearch(searchLimit, false);
 
-	buildExactCoverMatrix(exactCoverMatrix);
-	buildDLXLinkedList(exactCoverMatrix);
-	applyInitialConstraints(puzzle);
-	searchDLX(0, searchLimit, solutions);
+	if (timed)
+	{
+		const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if ((slowLog.wallTimeMs > 0 && elapsedMs >= slowLog.wallTimeMs) ||
+			(slowLog.nodeThreshold > 0 && searchNodes >= slowLog.nodeThreshold))
+			writeSlowLogEntry(puzzle, candidates, searchLimit, elapsedMs);
+	}
 
+	DLX_PROBE3(solve__done, gridSize, solutionCount, searchNodes);
 	return solutions;
 }
 
+void SudokuDLXSolver::setSlowLog(const SlowLogConfig& config)
+{
+	if (!config.path.empty() && config.maxEntries < 1)
+		throw std::invalid_argument("Slow log needs room for at least one entry, but got: " + std::to_string(config.maxEntries));
+
+	slowLog = config;
+}
+
+void SudokuDLXSolver::writeSlowLogEntry(const std::vector<std::vector<int>>& puzzle,
+										const std::vector<std::vector<std::uint64_t>>* candidates,
+										int searchLimit, double elapsedMs) const
+{
+	// One line per entry so it can be replayed directly:
+	// size=9 limit=10 hybrid=0 ms=12.5 nodes=1234 solutions=1 puzzle=8,0,0,... [candidates=1ff,...]
+	// Multi-grid layouts add canvas=21x21 after the size and list the whole canvas.
+	std::ostringstream entry;
+	entry << "size=" << gridSize;
+	if (height != gridSize || width != gridSize)
+		entry << " canvas=" << height << "x" << width;
+	entry << " limit=" << searchLimit << " hybrid=" << hybridThreshold
+		  << " ms=" << elapsedMs << " nodes=" << searchNodes << " solutions=" << solutionCount
+		  << " puzzle=";
+	for (int i = 0; i < height; ++i)
+		for (int j = 0; j < width; ++j)
+			entry << ((i | j) != 0 ? "," : "") << puzzle[i][j];
+	if (candidates != nullptr)
+	{
+		entry << " candidates=" << std::hex;
+		for (int i = 0; i < height; ++i)
+			for (int j = 0; j < width; ++j)
+				entry << ((i | j) != 0 ? "," : "") << (*candidates)[i][j];
+	}
+	entry << '\n';
+
+	// Entries per file are shared between all solvers writing to the same path. When a file is
+	// full it becomes path.1 (dropping the previous one) and a new file is started.
+	static std::mutex logMutex;
+	static std::map<std::string, int> entryCounts;
+
+	std::lock_guard<std::mutex> lock(logMutex);
+	std::map<std::string, int>::iterator count = entryCounts.find(slowLog.path);
+	if (count == entryCounts.end())
+	{
+		std::ifstream existing(slowLog.path);
+		int lines = 0;
+		for (std::string line; std::getline(existing, line); )
+			lines++;
+		count = entryCounts.insert(std::make_pair(slowLog.path, lines)).first;
+	}
+
+	if (count->second >= slowLog.maxEntries)
+	{
+		const std::string previous = slowLog.path + ".1";
+		std::remove(previous.c_str());
+		std::rename(slowLog.path.c_str(), previous.c_str());
+		count->second = 0;
+	}
+
+	std::ofstream out(slowLog.path, std::ios::app);
+	out << entry.str();
+	if (out)
+		count->second++;
+}
+
+SudokuSolverPool::Lease::Lease(SudokuSolverPool* owner, std::unique_ptr<SudokuDLXSolver> leased)
+	: pool(owner)
+	, solver(std::move(leased))
+{
+}
+
+SudokuSolverPool::Lease::Lease(Lease&& other) noexcept
+	: pool(other.pool)
+	, solver(std::move(other.solver))
+{
+	other.pool = nullptr;
+}
+
+SudokuSolverPool::Lease& SudokuSolverPool::Lease::operator=(Lease&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (pool != nullptr && solver)
+			pool->release(std::move(solver));
+		pool = other.pool;
+		solver = std::move(other.solver);
+		other.pool = nullptr;
+	}
+	return *this;
+}
+
+SudokuSolverPool::Lease::~Lease()
+{
+	if (pool != nullptr && solver)
+		pool->release(std::move(solver));
+}
+
+SudokuSolverPool::SudokuSolverPool(int concurrency)
+	: concurrency(concurrency > 0 ? concurrency : std::max(1, static_cast<int>(std::thread::hardware_concurrency())))
+{
+}
+
+std::unique_ptr<SudokuDLXSolver> SudokuSolverPool::createWarmSolver(int size)
+{
+	std::unique_ptr<SudokuDLXSolver> solver(new SudokuDLXSolver(size));
+
+	// Loading an empty grid allocates the link arrays, later loads reuse their capacity
+	solver->load(std::vector<std::vector<int>>(size, std::vector<int>(size, 0)));
+	return solver;
+}
+
+void SudokuSolverPool::preallocate(int size)
+{
+	size_t missing;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const size_t available = idle[size].size();
+		missing = available < static_cast<size_t>(concurrency) ? concurrency - available : 0;
+	}
+
+	// Build outside the lock so other sizes can still be leased meanwhile
+	std::vector<std::unique_ptr<SudokuDLXSolver>> created;
+	created.reserve(missing);
+	for (size_t i = 0; i < missing; ++i)
+		created.push_back(createWarmSolver(size));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<std::unique_ptr<SudokuDLXSolver>>& solvers = idle[size];
+	for (std::unique_ptr<SudokuDLXSolver>& solver : created)
+		if (solvers.size() < static_cast<size_t>(concurrency))
+			solvers.push_back(std::move(solver));
+}
+
+void SudokuSolverPool::preallocate(const std::vector<int>& sizes)
+{
+	for (int size : sizes)
+		preallocate(size);
+}
+
+SudokuSolverPool::Lease SudokuSolverPool::acquire(int size)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<std::unique_ptr<SudokuDLXSolver>>& solvers = idle[size];
+		if (!solvers.empty())
+		{
+			std::unique_ptr<SudokuDLXSolver> solver = std::move(solvers.back());
+			solvers.pop_back();
+			return Lease(this, std::move(solver));
+		}
+	}
+
+	return Lease(this, createWarmSolver(size));
+}
+
+size_t SudokuSolverPool::idleCount(int size) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<int, std::vector<std::unique_ptr<SudokuDLXSolver>>>::const_iterator it = idle.find(size);
+	return it == idle.end() ? 0 : it->second.size();
+}
+
+void SudokuSolverPool::release(std::unique_ptr<SudokuDLXSolver> solver)
+{
+	// The next tenant must neither run callbacks that may capture the previous tenant's locals
+	// nor see its puzzle
+	solver->resetForReuse();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<std::unique_ptr<SudokuDLXSolver>>& solvers = idle[solver->getGridSize()];
+
+	// Bursts above the configured concurrency are not kept around
+	if (solvers.size() < static_cast<size_t>(concurrency))
+		solvers.push_back(std::move(solver));
+}
+
 // Utility function implementations
 void printGrid(const std::vector<std::vector<int>>& grid)
 {
@@ -31,18 +31,266 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <string>
+#include <iosfwd>
+#include <functional>
+#include <map>
+#include <utility>
+#include <mutex>
 
-struct DLXNode
+// Vertical links of one node; the only per-node state that changes during cover/uncover
+struct DLXLink
 {
-	DLXNode* left;
-	DLXNode* right;
-	DLXNode* up;
-	DLXNode* down;
-	DLXNode* column;
-	int columnSize;
-	std::vector<int> rowData; // [value, row, col]
+	int up;
+	int down;
+};
+
+// Header-list links and size of one column (index 0 is the root header)
+struct DLXColumn
+{
+	int left;
+	int right;
+	int size;
+};
+
+struct DLXRowData
+{
+	int value;
+	int row;
+	int col;
+};
+
+// Every row of a standard Sudoku has exactly four nodes: cell, row-digit, col-digit, box-digit
+const int kFixedRowWidth = 4;
+
+// Top-left corner of one gridSize x gridSize grid on the canvas of a SudokuLayout
+struct GridPlacement
+{
+	int top;
+	int left;
+};
+
+// Additional "all different" region on top of the grids of a layout (Windoku windows, disjoint
+// groups, diagonals, ...). A primary region holds every digit exactly once and needs exactly
+// gridSize cells; a secondary region holds every digit at most once.
+struct ExtraRegion
+{
+	std::vector<std::pair<int, int>> cells; // zero-based canvas (row, col)
+	bool primary;
+};
+
+// Pairwise rules that are not exact cover constraints. Choosing a row removes the rows that
+// conflict with it, see SudokuLayout::exclusions.
+enum ExclusionRule
+{
+	kAntiKnight = 1,     // equal digits may not be a chess knight's move apart
+	kAntiKing = 2,       // equal digits may not touch, diagonally included
+	kNonConsecutive = 4  // orthogonal neighbours may not hold consecutive digits
+};
+
+// The digit at `smaller` is less than the digit at `larger` (zero-based canvas cells)
+struct Inequality
+{
+	std::pair<int, int> smaller;
+	std::pair<int, int> larger;
+};
+
+// Restricts a zero-based canvas cell to odd or even digits
+struct ParityCell
+{
+	std::pair<int, int> cell;
+	bool even;
+};
+
+// One or more Sudoku grids of the same size placed on a shared canvas. Every grid contributes its
+// own row, column and box constraints; a cell covered by several grids is a single puzzle cell,
+// and a box shared by several grids is a single box constraint. Canvas cells outside every grid
+// are not part of the puzzle (they are ignored on input and 0 in solutions).
+struct SudokuLayout
+{
+	int gridSize;
+	int height;
+	int width;
+	std::vector<GridPlacement> grids;
+	bool latinSquare; // no box constraint, so gridSize may be any order
+	std::vector<ExtraRegion> extraRegions;
+	int exclusions; // ExclusionRule flags, applied across the whole canvas
+	std::vector<Inequality> inequalities;
+	std::vector<ParityCell> parity;
+
+	// A gridSize x gridSize Latin square: every digit once per row and column
+	static SudokuLayout latin(int order);
+
+	// A single gridSize x gridSize Sudoku
+	static SudokuLayout single(int size);
+
+	// Samurai: four 9x9 corner grids sharing one box each with a central grid, 21x21 canvas
+	static SudokuLayout samurai();
 
-	DLXNode();
+	// 9x9 with four extra 3x3 windows at (1, 1), (1, 5), (5, 1) and (5, 5)
+	static SudokuLayout windoku();
+
+	// The cells at the same position of every box form an extra region
+	static SudokuLayout disjointGroups(int size);
+};
+
+// Read-only exact cover structure for one layout. Node indices 1..columnCount are the column
+// headers, row nodes follow row by row starting at a multiple of kFixedRowWidth. Instances are
+// shared between all solvers of the same layout (see forGridSize() and
+// SudokuDLXSolver::clone()), so nothing in here may change after construction.
+struct DLXTopology
+{
+	int gridSize;    // digits, and size of every grid of the layout
+	int blockSize;   // 0 for Latin squares
+	int height;      // canvas dimensions, gridSize x gridSize for a single grid
+	int width;
+	int cellCount;   // puzzle cells, canvas cells outside every grid excluded
+	int rowCount;
+	int columnCount;
+	int maxDepth;    // rows in any solution: one per cell, at most one per primary column (or its upper bound) in general
+	int primaryColumnCount; // columns after this one are secondary (covered at most once)
+	int rowWidth; // kFixedRowWidth when every row has that many nodes, 0 for mixed widths
+	size_t constructionBytes; // peak during construction, including the transient region lists
+
+	std::vector<int> nodeColumn;      // column header of each node
+	std::vector<int> nodeRow;         // exact cover row of each node (-1 for headers)
+	std::vector<int> nodeLeft;        // row siblings, fixed for the lifetime of the matrix
+	std::vector<int> nodeRight;
+	std::vector<DLXRowData> rowData;  // decoding table: exact cover row -> placement
+	std::vector<int> rowFirstNode;    // nodes of row r are [rowFirstNode[r], rowFirstNode[r + 1])
+	std::vector<int> cellIndex;       // canvas position row * width + col -> puzzle cell, -1 outside
+	std::vector<int> conflictStart;   // rows excluded by row r are conflictRows[conflictStart[r]..conflictStart[r + 1])
+	std::vector<int> conflictRows;    // both empty without exclusion rules or inequalities
+	std::vector<int> prunedRows;      // rows ruled out before search by parity and inequality bounds
+	std::vector<int> inequalityCells; // smaller and larger puzzle cell of every inequality, in pairs
+	std::vector<std::string> columnNames; // item names of generic problems (0 is the root), empty for Sudoku
+	std::vector<int> nodeColor;       // DLX2 color of each node, 0 for none; empty when no option uses colors
+	std::vector<std::string> colorNames; // names of colors 1.. (0 is the empty "no color")
+	std::vector<int> columnLower;     // DLX3 multiplicity bounds of each primary column, indexed by column;
+	std::vector<int> columnUpper;     // both empty when every primary column is covered exactly once
+
+	explicit DLXTopology(int size);
+	explicit DLXTopology(const SudokuLayout& layout);
+
+	// Generic exact cover problem without a grid: columns 1..primaryColumns are primary, the
+	// rest secondary. Every option lists distinct 1-based columns, at least one of them primary.
+	// optionColors, when not empty, parallels options: a color above 0 lets a secondary column be
+	// shared by any number of chosen options of that same color. bounds, when not empty, gives
+	// every primary column the number of chosen options that must contain it as {min, max}.
+	DLXTopology(std::vector<std::string> names, int primaryColumns, const std::vector<std::vector<int>>& options,
+				const std::vector<std::vector<int>>& optionColors = std::vector<std::vector<int>>(),
+				const std::vector<std::pair<int, int>>& bounds = std::vector<std::pair<int, int>>());
+
+	// Knuth's DLX1 text format: lines starting with '|' are comments, the first other line names
+	// the items (primary | secondary), every further line is an option. Secondary items may
+	// carry a DLX2 color as item:color, primary items DLX3 bounds as min:max|item or count|item.
+	// Throws std::invalid_argument naming the line of malformed input.
+	static std::shared_ptr<const DLXTopology> readDLX1(std::istream& in);
+
+	bool isCell(int row, int col) const { return cellIndex[row * width + col] >= 0; }
+
+	// Exact cover row of placing `value` at zero-based canvas (row, col), which must be a cell
+	int rowIndex(int value, int row, int col) const { return cellIndex[row * width + col] * gridSize + value - 1; }
+
+	// Thread-safe; returns the cached topology while any solver of this size still holds it
+	static std::shared_ptr<const DLXTopology> forGridSize(int size);
+
+	size_t memoryBytes() const;
+
+private:
+	void buildDLXLinkedList(const std::vector<std::vector<int>>& regions, int primaryRegions);
+	void buildConflicts(const SudokuLayout& layout);
+	void buildPrunedRows(const SudokuLayout& layout);
+	int layoutCell(const std::pair<int, int>& cell, const char* what) const;
+	bool sharesColumn(int rowA, int rowB) const;
+};
+
+struct SearchStats
+{
+	unsigned long long nodes; // search nodes visited, bitboard nodes included
+	int solutions;
+};
+
+// Zero-suppressed decision diagram over exact cover rows. Node 0 is the empty family, node 1
+// the family holding only the empty set; any other node stands for the solutions that take
+// `row` and continue at `hi`, plus those that continue at `lo` without it. The hi edges of a
+// path from the root to node 1 are the rows of one solution.
+struct ZDDNode
+{
+	int row; // -1 for the two terminals
+	int lo;
+	int hi;
+};
+
+struct SolutionZDD
+{
+	std::vector<ZDDNode> nodes; // children always precede their parents
+	int root;
+};
+
+// Solves that exceed either threshold are appended to `path`, one replayable line each.
+// When a file reaches maxEntries lines it is moved to path + ".1" and a new one is started.
+struct SlowLogConfig
+{
+	std::string path;                          // empty disables the slow log
+	double wallTimeMs = 0;                     // 0 ignores wall time
+	unsigned long long nodeThreshold = 0;      // 0 ignores the node count
+	int maxEntries = 1000;
+};
+
+// Bytes per category. The topology is shared by every solver of the same grid size, so it is
+// reported separately rather than charged to one solver.
+struct MemoryBreakdown
+{
+	size_t topology;  // shared read-only structure
+	size_t links;     // per-solver vertical links and column headers
+	size_t search;    // solver object, trail, solution stack, flags, progress and bitboard scratch
+	size_t solutions; // grids or ZDD returned by the last search (owned by the caller afterwards)
+
+	size_t total() const { return topology + links + search + solutions; }
+};
+
+struct MemoryUsage
+{
+	MemoryBreakdown current;
+	MemoryBreakdown peak;      // per category, over the solver's lifetime
+	MemoryBreakdown lastSolve; // per category, at the end of the last search
+};
+
+class SudokuDLXSolver;
+
+// View of the search state handed to a propagator (see SudokuDLXSolver::setPropagator()).
+// Cells are zero-based canvas coordinates, values 1..gridSize.
+class PropagationContext
+{
+public:
+	int getGridSize() const;
+	int getHeight() const;
+	int getWidth() const;
+
+	// Placement that triggered this call; value 0 for the call at the start of a search
+	int getLastRow() const { return lastRow; }
+	int getLastCol() const { return lastCol; }
+	int getLastValue() const { return lastValue; }
+
+	// Digit placed in the cell, 0 while it is open or outside every grid
+	int valueAt(int row, int col) const;
+
+	// True while `value` can still be placed in the open cell (or is the digit placed there)
+	bool isCandidate(int value, int row, int col) const;
+
+	// Removes `value` from the open cell; undone automatically when the search backtracks
+	void eliminate(int value, int row, int col);
+
+private:
+	friend class SudokuDLXSolver;
+	PropagationContext(SudokuDLXSolver& solver, int exactCoverRow);
+
+	SudokuDLXSolver& solver;
+	int lastRow;
+	int lastCol;
+	int lastValue;
 };
 
 class SudokuDLXSolver
@@ -50,39 +298,262 @@ class SudokuDLXSolver
 private:
 	const int gridSize;
 	const int blockSize;
+	const int height;
+	const int width;
 	const int cellCount;
-	const int exactCoverRows;
-	const int exactCoverCols;
 
-	DLXNode* rootHeader;
-	std::vector<DLXNode*> solution;
-	std::vector<DLXNode*> fixedClues;
-	std::vector<std::unique_ptr<DLXNode>> allNodes;
+	std::shared_ptr<const DLXTopology> topology;
+
+	// Per-solver mutable state: everything below is private to one thread
+	std::vector<DLXLink> links;
+	std::vector<DLXColumn> columns;
+	std::vector<int> solution;
+	std::vector<int> fixedClues; // trail of placed rows, undone in reverse by restoreState()
+	std::vector<char> columnCovered; // columns covered by givens and place(); during search only kept while rows are tracked
+	std::vector<char> rowExcluded;   // rows eliminated by pencil marks before search
+	std::vector<char> rowHidden;     // rows removed by exclusion rules or a propagator
+	std::vector<int> hiddenRows;     // trail of rowHidden, undone in reverse
+	std::vector<int> clueHidden;     // hiddenRows size before each trail entry, empty until rows are tracked
+	std::vector<int> placedRow;      // exact cover row placed in each cell, -1 while open; kept with markRow()
+	std::vector<int> nodeColor;      // topology colors, -1 while purified by a chosen node; empty without colors
+	std::vector<int> columnUses;     // chosen rows containing each primary column; empty without bounds
+	std::function<bool(PropagationContext&)> propagator;
 	int solutionCount;
+	int clueCount;
+	int givenCount; // the first givenCount trail entries come from load() and cannot be restored
+
+	// enumerateRows(): solutions go to the visitor as exact cover rows instead of grids
+	const std::function<bool(const std::vector<int>&)>* rowVisitor;
+	std::vector<int> visitedRows;
+	unsigned long long visitedSolutions;
+
+	// Progress reporting: branch index and branching factor of every open search level
+	std::vector<int> branchIndex;
+	std::vector<int> branchCount;
+	std::function<void(double)> progressCallback;
+	unsigned long long progressInterval;
+	unsigned long long progressCountdown;
+
+	// Hybrid mode: residual problems with at most hybridThreshold active columns are exported to
+	// one 64-bit mask per row and finished by searchBitboard() instead of dancing the links
+	struct BitboardResidual
+	{
+		std::vector<int> columnBit;          // active column header -> bit index
+		std::vector<std::uint64_t> rowMask;  // residual row -> columns it covers
+		std::vector<int> rowNode;            // residual row -> DLX node, for decoding solutions
+		std::vector<int> columnStart;        // bit -> first entry in columnRows
+		std::vector<int> columnRows;         // residual rows of each column, grouped by bit
+	};
+	BitboardResidual residual;
+	int hybridThreshold;
 
-	void coverColumn(DLXNode* col);
-	void uncoverColumn(DLXNode* col);
+	unsigned long long searchNodes;
+	SlowLogConfig slowLog;
+
+	size_t solutionBytes;
+	MemoryBreakdown lastSolveMemory;
+	MemoryBreakdown peakMemory;
+
+	bool unwindOnAbort; // false while solve() runs: load() resets the links before they are used again
+	bool loaded;        // links hold a consistent post-load() state
+	bool neverLoaded;   // no load() since construction, so an empty puzzle is implied
+
+	SudokuDLXSolver(const SudokuDLXSolver&) = default;
+
+	friend class PropagationContext;
+	friend class SudokuSolverPool;
+
+	void coverColumn(int col);
+	void uncoverColumn(int col);
+	void coverSiblings(int node);
+	void uncoverSiblings(int node);
+	void purify(int node);
+	void unpurify(int node);
+	void chooseRow(int node);
+	void unchooseRow(int node);
+	void searchBounded(int level, int k, int searchLimit, std::vector<std::vector<std::vector<int>>>& solutions);
+	struct MemoTable;
+	unsigned long long countMemoized(MemoTable& memo, int& zddNode);
+	void coverRow(int row);
+	void uncoverRow(int row);
 	void searchDLX(int k, int searchLimit, std::vector<std::vector<std::vector<int>>>& solutions);
-	void buildExactCoverMatrix(std::vector<std::vector<bool>>& exactCoverMatrix);
-	void buildDLXLinkedList(const std::vector<std::vector<bool>>& exactCoverMatrix);
-	DLXNode* findNodeForClue(int value, int row, int col);
-	void applyInitialConstraints(const std::vector<std::vector<int>>& puzzle);
-	void mapSolutionToGrid(std::vector<std::vector<int>>& sudoku);
+	std::vector<std::vector<std::vector<int>>> runSearch(int searchLimit, bool unwind);
+	std::vector<std::vector<std::vector<int>>> solveAndLog(const std::vector<std::vector<int>>& puzzle,
+															const std::vector<std::vector<std::uint64_t>>* candidates,
+															int searchLimit);
+	void writeSlowLogEntry(const std::vector<std::vector<int>>& puzzle,
+						   const std::vector<std::vector<std::uint64_t>>* candidates,
+						   int searchLimit, double elapsedMs) const;
+	void reportProgress(int depth);
+	MemoryBreakdown measureMemory() const;
+	void recordSolveMemory(size_t scratchBytes);
+	void exportResidual();
+	void searchBitboard(std::uint64_t remaining, int k, int searchLimit, std::vector<std::vector<std::vector<int>>>& solutions);
+	void recordSolution(int depth, int searchLimit, std::vector<std::vector<std::vector<int>>>& solutions);
+	bool isRowAvailable(int row) const;
+	void markRow(int row, bool covered);
+	int hideConflicts(int row);
+	void hideRow(int row);
+	bool tracksRows() const;
+	void resetForReuse();
+	void tightenBounds();
+	bool propagate(int row);
+	void unhideConflicts(int marker);
+	void loadState(const std::vector<std::vector<int>>& puzzle,
+				   const std::vector<std::vector<std::uint64_t>>* candidates);
+	void applyInitialConstraints(const std::vector<std::vector<int>>& puzzle,
+								 const std::vector<std::vector<std::uint64_t>>* candidates);
+	void mapSolutionToGrid(std::vector<std::vector<int>>& sudoku, int depth) const;
+	void validatePuzzle(const std::vector<std::vector<int>>& puzzle) const;
 
 public:
 	explicit SudokuDLXSolver(int size = 9);
+
+	// Overlapping multi-grid puzzles; puzzles and solutions are height x width canvases
+	explicit SudokuDLXSolver(const SudokuLayout& layout);
+
+	// Any topology, e.g. one from DLXTopology::readDLX1(). Without a grid only enumerateRows()
+	// and the statistics are available.
+	explicit SudokuDLXSolver(std::shared_ptr<const DLXTopology> sharedTopology);
 	~SudokuDLXSolver() = default;
 
-	SudokuDLXSolver(const SudokuDLXSolver&) = delete;
 	SudokuDLXSolver& operator=(const SudokuDLXSolver&) = delete;
 	SudokuDLXSolver(SudokuDLXSolver&&) = default;
 	SudokuDLXSolver& operator=(SudokuDLXSolver&&) = default;
 
+	// Independent copy in the same cover state (including placements), e.g. one per worker thread.
+	// The topology is shared, only the link state is copied.
+	SudokuDLXSolver clone() const;
+
 	std::vector<std::vector<std::vector<int>>> solve(const std::vector<std::vector<int>>& puzzle, 
 													  int searchLimit = 10);
 
+	// Pencil-mark input: bit (v - 1) of candidates[row][col] allows digit v in that empty cell,
+	// the rows of every other digit are removed before search (givens ignore their mask).
+	// Grid sizes up to 64.
+	std::vector<std::vector<std::vector<int>>> solve(const std::vector<std::vector<int>>& puzzle,
+													  const std::vector<std::vector<std::uint64_t>>& candidates,
+													  int searchLimit = 10);
+
+	// Incremental interface: load() resets the links and applies the givens without searching,
+	// place() covers one more cell as a hypothesis, search() runs DLX from the current state and
+	// leaves it unchanged. saveState() returns a trail marker that restoreState() rolls back to;
+	// the givens themselves are applied in bulk and cannot be rolled back.
+	// solve() does not restore the links when it stops at the search limit, so call load()
+	// again before using place(), search() or restoreState() after it.
+	void load(const std::vector<std::vector<int>>& puzzle);
+	void load(const std::vector<std::vector<int>>& puzzle,
+			  const std::vector<std::vector<std::uint64_t>>& candidates);
+	bool place(int row, int col, int value);
+	std::vector<std::vector<std::vector<int>>> search(int searchLimit = 10);
+	int saveState() const { return clueCount; }
+	void restoreState(int marker);
+
+	// Calls `visit` with the exact cover rows of every solution reachable from the current state
+	// until it returns false; returns the number of solutions visited. A solver that was never
+	// loaded starts from an empty puzzle; one whose links were invalidated (e.g. by a solve()
+	// that stopped at its limit) throws std::logic_error until load() is called again. Works
+	// with every topology and leaves the state unchanged.
+	unsigned long long enumerateRows(const std::function<bool(const std::vector<int>&)>& visit);
+
+	// Counts the solutions reachable from the current state by dancing with ZDDs: every search
+	// node is keyed by its set of covered columns, and a residual problem met again reuses the
+	// count found the first time. `zdd`, when given, receives all solutions with those
+	// subproblems shared, givens and placements included. The memo grows to at most `memoBytes`
+	// and then overwrites older entries; counts saturate at ULLONG_MAX. Like enumerateRows(), a
+	// never-loaded solver starts from an empty puzzle and one with invalidated links throws
+	// std::logic_error. Also throws with exclusion rules, inequalities, propagators, colors or
+	// multiplicities, whose residual problems depend on more than the covered columns. Leaves
+	// the state unchanged.
+	unsigned long long countSolutions(SolutionZDD* zdd = nullptr, size_t memoBytes = size_t(32) << 20);
+
+	// Predicted number of searchDLX() nodes for the current state (Knuth's estimate averaged over
+	// `samples` random root-to-leaf paths), e.g. to route or schedule expensive puzzles first.
+	// The state is unchanged afterwards; estimateCost() loads the puzzle first.
+	double estimateSearchCost(int samples = 64, unsigned seed = 1);
+	double estimateCost(const std::vector<std::vector<int>>& puzzle, int samples = 64, unsigned seed = 1);
+
+	// Calls `callback` every `interval` search nodes with Knuth's estimate of the fraction of the
+	// search tree explored so far: the sum over open levels of (branches done) / (product of
+	// branching factors down to that level). An empty callback disables reporting. An exception
+	// thrown by the callback ends the search and leaves the links covered, so call load() again.
+	void setProgressCallback(std::function<void(double)> callback, unsigned long long interval = 100000);
+
+	// Calls `propagator` after every row choice in search(), solve() and the cost estimator,
+	// after place() and once at the start of every search. It may eliminate candidates through
+	// the context, which the solver undoes on backtrack, and returns false when the current
+	// state cannot be completed. An empty function removes it; without one the search loop is
+	// unchanged. Not compatible with the hybrid bitboard mode. An exception thrown by the
+	// propagator reaches the caller with the links still covered, so call load() again.
+	void setPropagator(std::function<bool(PropagationContext&)> propagator);
+
+	// Finish residual problems with at most `columns` active columns (0 disables, max 64) with a
+	// bitboard search. The DLX links are only read while exporting, so no state has to be restored.
+	void setHybridThreshold(int columns);
+	int getHybridThreshold() const { return hybridThreshold; }
+
+	// Capture slow solve() calls for replay; the fast path only pays two clock reads when enabled
+	void setSlowLog(const SlowLogConfig& config);
+	SearchStats getLastSearchStats() const { return { searchNodes, solutionCount }; }
+
+	// Capacity-based byte counts of everything this solver allocated, see MemoryBreakdown
+	MemoryUsage getMemoryUsage() const;
+
 	int getGridSize() const { return gridSize; }
 	int getBlockSize() const { return blockSize; }
+	int getHeight() const { return height; }
+	int getWidth() const { return width; }
+	const std::shared_ptr<const DLXTopology>& getTopology() const { return topology; }
+};
+
+// Thread-safe pool of warm solvers keyed by grid size. Idle solvers keep their link arrays
+// allocated, so a lease only costs a mutex round trip. The pool must outlive its leases.
+class SudokuSolverPool
+{
+public:
+	// Gives the solver back to the pool when it goes out of scope
+	class Lease
+	{
+	public:
+		Lease(Lease&& other) noexcept;
+		Lease& operator=(Lease&& other) noexcept;
+		~Lease();
+
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+
+		SudokuDLXSolver& operator*() const { return *solver; }
+		SudokuDLXSolver* operator->() const { return solver.get(); }
+
+	private:
+		friend class SudokuSolverPool;
+		Lease(SudokuSolverPool* owner, std::unique_ptr<SudokuDLXSolver> leased);
+
+		SudokuSolverPool* pool;
+		std::unique_ptr<SudokuDLXSolver> solver;
+	};
+
+	// concurrency = 0 uses std::thread::hardware_concurrency()
+	explicit SudokuSolverPool(int concurrency = 0);
+
+	SudokuSolverPool(const SudokuSolverPool&) = delete;
+	SudokuSolverPool& operator=(const SudokuSolverPool&) = delete;
+
+	// Creates warm solvers until `concurrency` are idle for the given size
+	void preallocate(int size);
+	void preallocate(const std::vector<int>& sizes);
+
+	Lease acquire(int size);
+	size_t idleCount(int size) const;
+	int getConcurrency() const { return concurrency; }
+
+private:
+	void release(std::unique_ptr<SudokuDLXSolver> solver);
+	static std::unique_ptr<SudokuDLXSolver> createWarmSolver(int size);
+
+	const int concurrency;
+	mutable std::mutex mutex;
+	std::map<int, std::vector<std::unique_ptr<SudokuDLXSolver>>> idle;
 };
 
 // Utility functions